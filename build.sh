@@ -3,4 +3,6 @@ cd build
 cmake ../src
 make
 mv qcc ..
+mkdir -p ../lib
+mv libquackrt*.a ../lib
 cd ..
@@ -3,6 +3,7 @@ QuackOutput="QuackOutput"
 
 
 rm -rf build
+rm -rf lib
 
 if [ -f $qcc ] ; then
     rm -rf $qcc
@@ -11,4 +12,5 @@ fi
 if [ -f $QuackOutput ] ; then
     rm -rf $QuackOutput
     rm -rf QuackOutput.c
+    rm -rf QuackOutput.h QuackOutput_*.c QuackOutput*.o
 fi
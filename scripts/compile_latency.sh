@@ -0,0 +1,40 @@
+#!/usr/bin/env bash
+# Quack Compile Latency
+#
+# Runs qcc with the -time flag on every .qk file in a folder and totals how long
+# was spent in qcc itself (lexing through code generation) against how long was
+# spent in the C compiler. Programs that fail to type check are skipped since
+# they never reach the C compiler. Run this from the repository root, the same
+# place qcc is normally run from.
+
+if [[ $# -lt 2 ]] ; then
+    echo "Correct command \"compile_latency.sh <BinFile> <SamplesFolder> [-O0|-O1|-O2|-O3]\""
+    exit 1
+fi
+
+BIN=$1
+SAMPLES_FOLDER=$2
+OPT=${3:--O0}
+
+COMPILED=0
+QCC_TOTAL=0
+GCC_TOTAL=0
+
+for TEST_FILE in ${SAMPLES_FOLDER}/*.qk ; do
+    # qcc prints "qcc: <ms> ms, gcc <opt>: <ms> ms" to stderr
+    TIMES=$( ${BIN} ${TEST_FILE} -time ${OPT} 2>&1 >/dev/null | grep "^qcc: " )
+    if [[ -z "${TIMES}" ]] ; then
+        continue
+    fi
+    ((COMPILED++))
+    QCC_MS=$( echo "${TIMES}" | awk '{ print $2 }' )
+    GCC_MS=$( echo "${TIMES}" | awk '{ print $6 }' )
+    QCC_TOTAL=$( echo "${QCC_TOTAL} ${QCC_MS}" | awk '{ print $1 + $2 }' )
+    GCC_TOTAL=$( echo "${GCC_TOTAL} ${GCC_MS}" | awk '{ print $1 + $2 }' )
+done
+
+echo "${COMPILED} programs compiled with gcc ${OPT}"
+echo "${QCC_TOTAL} ${GCC_TOTAL} ${COMPILED}" | awk '{
+    printf "qcc total: %.1f ms (%.2f ms per program)\n", $1, $1 / ($3 ? $3 : 1)
+    printf "gcc total: %.1f ms (%.2f ms per program)\n", $2, $2 / ($3 ? $3 : 1)
+}'
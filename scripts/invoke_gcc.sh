@@ -1 +1,15 @@
-gcc QuackOutput.c src/Builtins.c -Isrc -w -o QuackOutput
\ No newline at end of file
+# Usage: invoke_gcc.sh [optimization flags]
+# Builds QuackOutput from QuackOutput.c and the runtime. With no flags the
+# C is compiled unoptimized (-O0), which is the quickest edit-compile-run loop.
+OPT="-O0"
+if [ $# -gt 0 ] ; then
+    OPT="$*"
+fi
+
+# link the prebuilt runtime from build.sh if it's there, otherwise compile Builtins.c too
+RUNTIME="src/Builtins.c"
+if [ -f lib/libquackrt.a ] ; then
+    RUNTIME="lib/libquackrt.a"
+fi
+
+gcc -pipe $OPT QuackOutput.c $RUNTIME -Isrc -w -o QuackOutput
@@ -0,0 +1,48 @@
+#!/usr/bin/env bash
+# Quack PGO Benchmark
+#
+# Builds a program three ways and times each build's QuackOutput: plain -O2,
+# -O2 with -pgo=generate (the instrumented training build), and -O2 with
+# -pgo=use after one training run. The best of several runs is reported for
+# each, since the first run of a program is often slower than the rest. Run
+# this from the repository root, the same place qcc is normally run from.
+
+if [[ $# -lt 2 ]] ; then
+    echo "Correct command \"pgo_benchmark.sh <BinFile> <Program.qk> [Runs]\""
+    exit 1
+fi
+
+BIN=$1
+PROGRAM=$2
+RUNS=${3:-5}
+PROFILE_DIR=QuackOutput.pgo
+
+# prints the best wall clock time, in seconds, of running QuackOutput ${RUNS} times
+best_time() {
+    local BEST=""
+    local TIMEFORMAT=%R
+    for ((RUN = 0; RUN < RUNS; RUN++)) ; do
+        local ELAPSED=$( { time ./QuackOutput >/dev/null 2>&1 ; } 2>&1 )
+        if [[ -z "${BEST}" ]] || awk "BEGIN { exit !(${ELAPSED} < ${BEST}) }" ; then
+            BEST=${ELAPSED}
+        fi
+    done
+    echo "${BEST}"
+}
+
+${BIN} ${PROGRAM} -O2 2>/dev/null || exit 1
+PLAIN=$( best_time )
+
+${BIN} ${PROGRAM} -O2 -pgo=generate=${PROFILE_DIR} 2>/dev/null || exit 1
+INSTRUMENTED=$( best_time )
+
+# the timing runs above were training runs too, so start the profile over with just one
+${BIN} ${PROGRAM} -O2 -pgo=generate=${PROFILE_DIR} 2>/dev/null || exit 1
+./QuackOutput >/dev/null 2>&1
+${BIN} ${PROGRAM} -O2 -pgo=use=${PROFILE_DIR} 2>/dev/null || exit 1
+OPTIMIZED=$( best_time )
+
+echo "-O2:               ${PLAIN} s"
+echo "-O2 -pgo=generate: ${INSTRUMENTED} s"
+echo "-O2 -pgo=use:      ${OPTIMIZED} s"
+echo "${PLAIN} ${OPTIMIZED}" | awk '{ printf "speedup from PGO:  %.2fx\n", $1 / ($2 ? $2 : 1) }'
@@ -3,7 +3,8 @@
 
 #include <set>
 
-enum Type {   
+// a byte is plenty, and keeps the header of an AST::Node small
+enum Type : unsigned char {   
                 // Non-Terminal Node Types (And Some Extras)
                 UNINITIALIZED,
                 PROGRAM, BLOCK,
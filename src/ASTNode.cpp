@@ -24,100 +24,59 @@ namespace AST {
     /* Inserting & Getting Data */
     /* ======================== */
 
-    void Node::insert(Node *node) {
-        // Check for a NULL node before inserting to avoid an insane amount of problems
-        if (node == NULL) { return; }
-
-        // If this type of node is not in the map yet, need a new vector for it to be inserted
-        if (this->children.count(node->type) == 0) {
-            std::vector<Node *> insertedNodeVector;
-            node->isLastNode = true;
-            insertedNodeVector.push_back(node);
-
-            this->children.insert(std::map<Type, std::vector<Node *> >::value_type(node->type, insertedNodeVector));
+    void NodeList::push_back(Node *node, Arena &arena) {
+        // out of room, so move everything to an array twice the size. the old one
+        // stays in the arena until it goes
+        if (count == capacity) {
+            Node **grown = (Node**) arena.allocate(capacity * 2 * sizeof(Node*), alignof(Node*));
+            std::copy(begin(), end(), grown);
+            items.heap = grown;
+            capacity *= 2;
         }
-        // Else, find that type in the map and push this new node into its vector
-        else {
-            std::map<Type, std::vector<Node *> >::iterator it = this->children.find(node->type);
-            if (it != this->children.end()) {
-                if (it->second.size() != 0) {
-                    it->second[it->second.size() - 1]->isLastNode = false;
-                }
+        ((capacity > INLINE) ? items.heap : items.local)[count++] = node;
+    }
 
-                node->isLastNode = true;
-                it->second.push_back(node);
-            }
-        }
+    const std::string Node::noName;
 
-         // If this type of node is being inserted for the first time,  it needs to go
-         // into the "order" vector to know when it was inserted, this is for the json
-         // printing
-        std::vector<Type>::iterator it = std::find(order.begin(), order.end(), node->type);
-        if (it == order.end()) {
-            order.push_back(node->type);
-        }
+    void Node::insert(Node *node, Arena &arena) {
+        // Check for a NULL node before inserting to avoid an insane amount of problems
+        if (node == NULL) { return; }
 
-        this->rawChildren.push_back(node);
+        // a node without a token of its own starts where its first child does
+        if (this->line == 0) {
+            this->line = node->line;
+        }
+        this->rawChildren.push_back(node, arena);
     }
 
     Node * Node::get(Type type) {
-        // Finds a given type of node in the map, returns the first node in its vector.
-        // This is used when getting types of nodes that only have one identifier, such
-        // as a class name, etc.
-         
-        std::map<Type, std::vector<Node *> >::iterator it = this->children.find(type);
-        if (it != this->children.end()) {
-            return it->second.front();
-        } else { return NULL; }
+        // Finds the first child of a given type. This is used when getting types of
+        // nodes that only have one identifier, such as a class name, etc.
+        for (Node *child : this->rawChildren) {
+            if (child->type == type) return child;
+        }
+        return NULL;
     }
 
     Node * Node::getBySubtype(Type subType) {
-        // Finds a given type of node in the map, returns the first node in its vector.
-        // This is used when getting types of nodes that only have one identifier, such
-        // as a class name, etc.
-        
-        Node *retNode = NULL;
         for (Node *child : this->rawChildren) {
             if (child->subType == subType) return child;
         }
-
-        return retNode;
+        return NULL;
     }
 
     Node * Node::get(Type type, Type subType) {
-        std::map<Type, std::vector<Node *> >::iterator it = this->children.find(type);
-        if (it != this->children.end()) {
-            for (Node* node : it->second) {
-                if (node->subType == subType) {
-                    return node;
-                }
-            }
-            return NULL;
-        } else { return NULL; }
-    }
-
-    std::vector<Node *> Node::getAll(Type type) {
-        // Finds a given type of node in the map, returns its associated vector.
-        // This is used when getting types of nodes that are sequences, such as
-        // function arguments, etc.
-
-        std::map<Type, std::vector<Node *> >::iterator it = children.find(type);
-        if (it != this->children.end()) {
-            return it->second;
-        } else { return std::vector<Node *>(); }
+        for (Node *child : this->rawChildren) {
+            if (child->type == type && child->subType == subType) return child;
+        }
+        return NULL;
     }
 
-    std::vector<Node *> Node::getAll(Type type, Type subType) {
-        std::map<Type, std::vector<Node *> >::iterator it = children.find(type);
-        if (it != this->children.end()) {
-            std::vector<Node *> retVec;
-            for (Node* node : it->second) {
-                if (node->subType == subType) {
-                    retVec.push_back(node);
-                }
-            }
-            return retVec;
-        } else { return std::vector<Node *>(); }
+    bool Node::firstOfType(size_t i) const {
+        for (size_t j = 0; j < i; j++) {
+            if (rawChildren[j]->type == rawChildren[i]->type) return false;
+        }
+        return true;
     }
 
     /* ===================== */
@@ -133,7 +92,7 @@ namespace AST {
         }
     }
 
-    void Node::json_head(std::string node_kind, std::ostream& out, AST_print_context& ctx) {
+    void Node::json_head(const char *node_kind, std::ostream& out, AST_print_context& ctx) {
         json_indent(out, ctx);
         out << "{ \"kind\" : \"" << node_kind << "\", " ;
         ctx.indent();
@@ -145,7 +104,7 @@ namespace AST {
         ctx.dedent();
     }
 
-    void Node::json_child(std::string field, Node* child, std::ostream& out, AST_print_context& ctx, char sep) {
+    void Node::json_child(const char *field, Node* child, std::ostream& out, AST_print_context& ctx, char sep) {
         out << sep;
         json_indent(out, ctx);
         out << "\"" << field << "\" : ";
@@ -153,17 +112,26 @@ namespace AST {
     }
 
     void Node::jsonSeq(std::ostream& out, AST_print_context& ctx) {
-        json_head(typeString(this->type), out, ctx);
+        json_head(TypeString[this->type], out, ctx);
         out << "\"elements_\" : [";
-        for (Type t : this->order) {
-            std::vector<Node*> subchildren = this->getAll(t);
-            for (Node* node : subchildren) {
+        // children are listed grouped by type, in the order each type first turned up.
+        // a block puts a comma after every group but the last one's
+        Type lastGroup = UNINITIALIZED;
+        for (size_t i = 0; i < rawChildren.size(); i++) {
+            if (firstOfType(i)) lastGroup = rawChildren[i]->type;
+        }
+        for (size_t i = 0; i < rawChildren.size(); i++) {
+            if (!firstOfType(i)) continue;
+            ChildRange subchildren = this->getAll(rawChildren[i]->type);
+            for (ChildRange::iterator it = subchildren.begin(); it != subchildren.end(); ) {
+                Node *node = *it;
+                bool isLastNode = (++it == subchildren.end());
                 node->json(out, ctx);
-                if (!node->isLastNode) {
+                if (!isLastNode) {
                     out << ",";
                 } else if (this->type == BLOCK && 
-                           node->isLastNode &&
-                           (node->type != this->order[this->order.size() - 1])) {
+                           isLastNode &&
+                           (node->type != lastGroup)) {
                     out << ",";
                 }
                 else {
@@ -184,22 +152,22 @@ namespace AST {
         if (isSeqType(this->type)) {
             jsonSeq(out, ctx);
         } else {
-            json_head(typeString(this->type), out, ctx);
+            json_head(TypeString[this->type], out, ctx);
             
-            if (this->nameinit) {
-                out << "\"text_\" : \"" << this->name << "\"";
-            } else if (this->valueinit) {
+            if (this->symbol != NO_SYMBOL) {
+                out << "\"text_\" : \"" << this->name() << "\"";
+            } else if (this->type == INTCONST) {
                 out << "\"value_\" : \"" << this->value << "\"";
             }
 
             auto sep = ' ';
-            for (Type t : this->order) {
-                std::vector<Node*> subchildren = this->getAll(t);
-                for (Node* node : subchildren) {
+            for (size_t i = 0; i < rawChildren.size(); i++) {
+                if (!firstOfType(i)) continue;
+                for (Node* node : this->getAll(rawChildren[i]->type)) {
                     if (node->subType != UNINITIALIZED) {
-                        this->json_child(typeString(node->subType), node, out, ctx, sep);
+                        this->json_child(TypeString[node->subType], node, out, ctx, sep);
                     } else {
-                        this->json_child(typeString(node->type), node, out, ctx, sep);
+                        this->json_child(TypeString[node->type], node, out, ctx, sep);
                     }
                     
                     sep = ',';
@@ -213,4 +181,26 @@ namespace AST {
             json_close(out, ctx);
         }
     }
-}
\ No newline at end of file
+
+    void Node::serialize(std::string& out) const {
+        out += std::to_string(type);
+        out += '.';
+        out += std::to_string(subType);
+        out += ' ';
+        if (symbol != NO_SYMBOL) {
+            const std::string &text = name();
+            out += std::to_string(text.size());
+            out += ':';
+            out += text;
+        }
+        out += ' ';
+        out += std::to_string(value);
+        out += ' ';
+        out += std::to_string(rawChildren.size());
+        out += '(';
+        for (Node *child : rawChildren) {
+            child->serialize(out);
+        }
+        out += ')';
+    }
+}
@@ -9,7 +9,9 @@
 #include <iostream>
 #include <algorithm>
 #include "ASTEnum.h"
+#include "arena.h"
 #include "Messages.h"
+#include "symbols.h"
 
 namespace AST {
 
@@ -23,6 +25,44 @@ namespace AST {
             void dedent() { --indent_; }
     };
 
+    class Node;
+
+    // A node's children, in the order they were inserted. Most nodes have three or
+    // fewer, so those are kept right in the node, and only longer lists (a block's
+    // statements, a class's methods) get an array of their own, in the same arena
+    // as the nodes.
+    class NodeList {
+        public:
+            typedef Node *const *const_iterator;
+
+            NodeList() {};
+            NodeList(const NodeList&) = delete;
+            NodeList &operator=(const NodeList&) = delete;
+
+            void push_back(Node *node, Arena &arena);
+
+            const_iterator begin() const { return data(); }
+            const_iterator end() const { return data() + count; }
+            size_t size() const { return count; }
+            bool empty() const { return count == 0; }
+            Node *operator[](size_t i) const { return data()[i]; }
+            Node *front() const { return data()[0]; }
+            Node *back() const { return data()[count - 1]; }
+
+        private:
+            static const unsigned int INLINE = 3;
+            unsigned int count = 0;
+            unsigned int capacity = INLINE;
+            union {
+                Node *local[INLINE];
+                Node **heap;
+            } items;
+
+            Node *const *data() const { return (capacity > INLINE) ? items.heap : items.local; }
+    };
+
+    class ChildRange;
+
     class Node {
         public:
             /* ============ */
@@ -31,50 +71,55 @@ namespace AST {
 
             Type type; // represents the type of this node
             Type subType = UNINITIALIZED;
-            std::map<Type, std::vector<Node*> > children; // contains all of the children
-            std::vector<Node*> rawChildren;
-            std::vector<Type> order; // tracks the order of input
-            
-            std::string name; // used for IDENT and STRCONST
-            bool nameinit = false;
 
-            int value; // used for INTCONST
-            bool valueinit = false;
+            bool skip = false; // for type checking (dont want to report the same error more than once)
 
-            bool isLastNode = false;
-            bool isLastOrder = false;
+            unsigned int line = 0; // the line of the first token under this node, 0 if there isn't one
+            Symbol symbol = NO_SYMBOL; // the interned name, for IDENT and STRCONST
+            int value = 0; // used for INTCONST
 
-            bool skip = false; // for type checking (dont want to report the same error more than once)
+            // the static type type inference settled on for this node. NO_SYMBOL until
+            // inference has visited the node
+            Symbol staticType = NO_SYMBOL;
+
+            NodeList rawChildren;
 
             /* ========================== */
             /* Constructors & Destructors */
             /* ========================== */
 
             Node(Type type) : type(type) {}; // used for most nodes
-            Node(Type type, std::string name) : type(type), name(name), nameinit(true) {}; // used for strconst
-            Node(Type type, Type subType, std::string name) : type(type), subType(subType), name(name), nameinit(true) {}; // used for strconst
-            Node(Type type, int value) : type(type), value(value), valueinit(true) {};
-            virtual ~Node() {};
+            Node(Type type, const std::string &name) : type(type), symbol(symbols.intern(name)) {}; // used for strconst
+            Node(Type type, Type subType, const std::string &name) : type(type), subType(subType), symbol(symbols.intern(name)) {}; // used for strconst
+            Node(Type type, Symbol symbol) : type(type), symbol(symbol) {}; // used for idents and strconsts from the lexer
+            Node(Type type, int value) : type(type), value(value) {};
+
+            // nodes only go in an arena, "new (arena) AST::Node(...)", and are freed with it
+            static void *operator new(size_t size, Arena &arena) { return arena.allocate(size, alignof(Node)); }
+            static void operator delete(void *, Arena &) {};
+
+            // the name the node's symbol stands for, or "" if it doesn't have one
+            const std::string &name() const { return (symbol == NO_SYMBOL) ? noName : symbols.name(symbol); }
 
             /* ======================== */
             /* Inserting & Getting Data */
             /* ======================== */
 
-            void insert(Node* inputNode);
+            void insert(Node* inputNode, Arena &arena);
             Node* get(Type type); // if you know there is only a single node of this type, use get
             Node* getBySubtype(Type type);
             Node* get(Type type, Type subType); // second argument is for subtype
-            std::vector<Node *> getAll(Type type); // if there can be multiple, use getAll
-            std::vector<Node *> getAll(Type type, Type subType); // second argument is for subtype
+            ChildRange getAll(Type type) const; // if there can be multiple, use getAll
+            ChildRange getAll(Type type, Type subType) const; // second argument is for subtype
 
             /* ===================== */
             /* JSON Printing Methods */
             /* ===================== */
 
             void json_indent(std::ostream& out, AST_print_context& ctx);
-            void json_head(std::string node_kind, std::ostream& out, AST_print_context& ctx);
+            void json_head(const char *node_kind, std::ostream& out, AST_print_context& ctx);
             void json_close(std::ostream& out, AST_print_context& ctx);
-            void json_child(std::string field, Node* child, std::ostream& out, AST_print_context& ctx, char sep=',');
+            void json_child(const char *field, Node* child, std::ostream& out, AST_print_context& ctx, char sep=',');
             void jsonSeq(std::ostream& out, AST_print_context& ctx);
 
             /* ================ */
@@ -82,7 +127,79 @@ namespace AST {
             /* ================ */
 
             void json(std::ostream& out, AST_print_context& ctx);
+
+            /* ============= */
+            /* Serialization */
+            /* ============= */
+
+            // appends the whole tree to out, every node's children in the order they were
+            // inserted (unlike the JSON, which groups them by type). names are length
+            // prefixed, so two different trees never come out the same. lines are left
+            // out, so moving code around without changing it doesn't change the result
+            void serialize(std::string& out) const;
+
+        private:
+            static const std::string noName;
+
+            // whether child i is the first of its type. the JSON lists children grouped by
+            // type, in the order each type first turned up
+            bool firstOfType(size_t i) const;
         };
+
+    // The children of a node that have a given type (and, if asked for, subtype), in
+    // order. It's a view over the node's NodeList, so walking it just skips past the
+    // other children and nothing is copied.
+    class ChildRange {
+        public:
+            class iterator {
+                public:
+                    iterator(NodeList::const_iterator at, const ChildRange &range) 
+                        : at(at), last(range.last), type(range.type), subType(range.subType), anySubType(range.anySubType) { skip(); }
+
+                    Node *operator*() const { return *at; }
+                    iterator &operator++() { ++at; skip(); return *this; }
+                    bool operator==(const iterator &other) const { return at == other.at; }
+                    bool operator!=(const iterator &other) const { return at != other.at; }
+
+                private:
+                    NodeList::const_iterator at;
+                    NodeList::const_iterator last;
+                    Type type;
+                    Type subType;
+                    bool anySubType;
+
+                    void skip() {
+                        while (at != last && ((*at)->type != type || (!anySubType && (*at)->subType != subType))) ++at;
+                    }
+            };
+
+            ChildRange(const NodeList &children, Type type) 
+                : first(children.begin()), last(children.end()), type(type), subType(UNINITIALIZED), anySubType(true) {};
+            ChildRange(const NodeList &children, Type type, Type subType) 
+                : first(children.begin()), last(children.end()), type(type), subType(subType), anySubType(false) {};
+
+            iterator begin() const { return iterator(first, *this); }
+            iterator end() const { return iterator(last, *this); }
+            bool empty() const { return begin() == end(); }
+            Node *front() const { return *begin(); }
+
+            // counts them, so it's a walk over the children
+            size_t size() const {
+                size_t count = 0;
+                for (iterator it = begin(); it != end(); ++it) count++;
+                return count;
+            }
+
+        private:
+            NodeList::const_iterator first;
+            NodeList::const_iterator last;
+            Type type;
+            Type subType;
+            bool anySubType;
+    };
+
+    inline ChildRange Node::getAll(Type type) const { return ChildRange(rawChildren, type); }
+    inline ChildRange Node::getAll(Type type, Type subType) const { return ChildRange(rawChildren, type, subType); }
 }
 
 #endif
\ No newline at end of file
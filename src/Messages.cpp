@@ -15,6 +15,9 @@ static bool debug = false;
 static bool verbose = false;
 static bool generateImage = false;
 
+// the Diagnostics this thread is collecting into, if any
+static thread_local Diagnostics *collecting = NULL;
+
 std::map<CompStage, int> error_count {
     {LEXER, 0},
     {PARSER, 0},
@@ -77,20 +80,21 @@ bool getGenerateImage() {
 // /path/to/file:32:9: error: expression is not assignable
 void error_at(const yy::location& loc, const std::string& msg, CompStage stage) {
     RED << stageString(stage) << msg << " at " << loc << "" << END;
-    if (++error_count[stage] > error_limit) {
-        bail(stage);
-    }
+    trackError(stage);
 }
 
 // An error that we can't locate in the input
 void error(const std::string& msg, CompStage stage) {
     RED << stageString(stage) << msg << "" << END;
-    if (++error_count[stage] > error_limit) {
-        bail(stage);
-    }
+    trackError(stage);
 }
 
 void trackError(CompStage stage) {
+    if (collecting != NULL) {
+        collecting->entries.push_back(std::make_pair(collecting->pending.str(), stage));
+        collecting->pending.str("");
+        return;
+    }
     if (++error_count[stage] > error_limit) {
         bail(stage);
     }
@@ -98,7 +102,7 @@ void trackError(CompStage stage) {
 
 // Additional diagnostic message, does not count against error limit
 void note(const std::string& msg, CompStage stage) {
-    std::cerr << "\033[1;37m" << stageString(stage) << msg << "" << END;
+    err() << "\033[1;37m" << stageString(stage) << msg << "" << END;
 }
 
 // Additional diagnostic message, does not count against error limit
@@ -150,4 +154,20 @@ bool ok() {
     return true;
 }
 
+void Diagnostics::replay() {
+    for (auto &entry : entries) {
+        std::cerr << entry.first;
+        trackError(entry.second);
+    }
+    std::cerr << pending.str() << std::flush;
+}
+
+void collect(Diagnostics *diagnostics) {
+    collecting = diagnostics;
+}
+
+std::ostream &err() {
+    return (collecting != NULL) ? (std::ostream &) collecting->pending : std::cerr;
+}
+
 };
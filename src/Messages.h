@@ -11,14 +11,18 @@
 
 #include "location.hh"
 #include <map>
+#include <ostream>
+#include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 // using preprocessor directives isn't a good thing...  
 // but I couldn't think of a better way to do this all over the code.
 #define OUT std::cout << "\033[39m"
-#define RED std::cerr << "\033[1;91m"
-#define YLW std::cerr << "\033[1;93m"
-#define GRN std::cerr << "\033[1;92m"
+#define RED report::err() << "\033[1;91m"
+#define YLW report::err() << "\033[1;93m"
+#define GRN report::err() << "\033[1;92m"
 #define END "\033[0m" << std::endl
 
 enum CompStage {
@@ -76,6 +80,23 @@ namespace report {
 
     // for use in the driver after all stages are complete
     void dynamicBail();
+
+    // Messages written by a check running on a worker thread are held here instead
+    // of going straight to stderr (along with the errors they count), so that they
+    // can be replayed afterwards in the same order a serial run would print them
+    struct Diagnostics {
+        std::vector<std::pair<std::string, CompStage> > entries; // text, and the stage of the error that ends it
+        std::ostringstream pending;
+
+        // print everything and count the errors, bailing at the error limit like trackError
+        void replay();
+    };
+
+    // send this thread's messages to diagnostics, or back to stderr with NULL
+    void collect(Diagnostics *diagnostics);
+
+    // where messages go on this thread (stderr unless collecting)
+    std::ostream &err();
 };
 
 
@@ -0,0 +1,22 @@
+#include <cstdlib>
+#include <new>
+#include "arena.h"
+
+Arena::~Arena() {
+	for (char *chunk : chunks) {
+		std::free(chunk);
+	}
+}
+
+// start a new chunk, big enough for this allocation if it's a big one
+void *Arena::grow(size_t size, size_t align) {
+	size_t bytes = (size + align > CHUNK_SIZE) ? size + align : CHUNK_SIZE;
+	char *chunk = (char*) std::malloc(bytes);
+	if (chunk == NULL) throw std::bad_alloc();
+	chunks.push_back(chunk);
+	reservedBytes += bytes;
+
+	next = chunk;
+	end = chunk + bytes;
+	return allocate(size, align);
+}
@@ -0,0 +1,55 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Memory for everything that lives as long as a compilation does (the AST and its
+// child lists). Allocating just bumps a pointer through big chunks, nothing is
+// freed on its own, and the chunks all go back at once when the arena does.
+class Arena {
+	public:
+        /* ========================== */
+        /* Constructors & Destructors */
+        /* ========================== */
+
+        Arena() {};
+        virtual ~Arena();
+        Arena(const Arena&) = delete;
+        Arena &operator=(const Arena&) = delete;
+
+        /* ======= */
+        /* Methods */
+        /* ======= */
+
+        // size bytes, aligned to align (a power of two)
+        void *allocate(size_t size, size_t align) {
+                if (next != NULL) {
+                        char *start = (char*) (((uintptr_t) next + align - 1) & ~(uintptr_t) (align - 1));
+                        if (start + size <= end) {
+                                next = start + size;
+                                usedBytes += size;
+                                return start;
+                        }
+                }
+                return grow(size, align);
+        }
+
+        // how much has been handed out, and how much was taken from the system for it
+        size_t used() const { return usedBytes; }
+        size_t reserved() const { return reservedBytes; }
+
+	private:
+        static const size_t CHUNK_SIZE = 64 * 1024;
+
+        std::vector<char*> chunks;
+        char *next = NULL;
+        char *end = NULL;
+        size_t usedBytes = 0;
+        size_t reservedBytes = 0;
+
+        void *grow(size_t size, size_t align);
+};
+
+#endif
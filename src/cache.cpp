@@ -0,0 +1,298 @@
+#include "cache.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+// 128-bit FNV-1a; wide enough that two different builds won't share a key
+typedef unsigned __int128 hash128;
+
+static void hashField(hash128 &hash, const std::string &data) {
+	const hash128 prime = ((hash128) 1 << 88) + 0x13b;
+	// length first, so that fields can't run into each other
+	std::string field = std::to_string(data.size()) + ":" + data;
+	for (unsigned char c : field) {
+		hash ^= c;
+		hash *= prime;
+	}
+}
+
+// mkdir -p
+static void makeDirs(std::string path) {
+	for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+		mkdir(path.substr(0, slash).c_str(), 0755);
+		if (slash == std::string::npos) break;
+	}
+}
+
+// the files (or directories) directly inside path
+static std::vector<std::string> listDir(std::string path) {
+	std::vector<std::string> names;
+	DIR *d = opendir(path.c_str());
+	if (!d) return names;
+	while (struct dirent *ent = readdir(d)) {
+		if (std::strcmp(ent->d_name, ".") != 0 && std::strcmp(ent->d_name, "..") != 0) {
+			names.push_back(ent->d_name);
+		}
+	}
+	closedir(d);
+	return names;
+}
+
+// entries never contain subdirectories, so this only has to go one level deep
+static void removeDir(std::string path) {
+	for (auto name : listDir(path)) {
+		unlink((path + "/" + name).c_str());
+	}
+	rmdir(path.c_str());
+}
+
+static long long dirSize(std::string path) {
+	long long size = 0;
+	struct stat st;
+	for (auto name : listDir(path)) {
+		if (stat((path + "/" + name).c_str(), &st) == 0) {
+			size += st.st_size;
+		}
+	}
+	return size;
+}
+
+Cache::Cache() {
+	if (const char *env = std::getenv("QCC_CACHE_DIR")) {
+		dir = env;
+	} else if (const char *xdg = std::getenv("XDG_CACHE_HOME")) {
+		dir = std::string(xdg) + "/qcc";
+	} else {
+		const char *home = std::getenv("HOME");
+		dir = std::string(home ? home : ".") + "/.cache/qcc";
+	}
+
+	long long megabytes = 512;
+	if (const char *size = std::getenv("QCC_CACHE_SIZE")) {
+		megabytes = std::atoll(size);
+	}
+	maxBytes = megabytes * 1024 * 1024;
+}
+
+void Cache::computeKey(const std::string &program, std::vector<std::string> flags, std::vector<std::string> inputs) {
+	hash128 hash = ((hash128) 0x6c62272e07bb0142ULL << 64) | 0x62b821756295c58dULL;
+
+	// bump this when the layout of an entry changes
+	hashField(hash, "qcc-cache-1");
+	hashField(hash, program);
+
+	// a rebuilt qcc or an upgraded gcc changes size or modification time
+	hashField(hash, toolVersion("/proc/self/exe"));
+	std::string gcc = "gcc";
+	if (const char *path = std::getenv("PATH")) {
+		std::stringstream dirs(path);
+		std::string pathDir;
+		while (std::getline(dirs, pathDir, ':')) {
+			if (access((pathDir + "/gcc").c_str(), X_OK) == 0) {
+				gcc = pathDir + "/gcc";
+				break;
+			}
+		}
+	}
+	hashField(hash, gcc + " " + toolVersion(gcc));
+
+	// Builtins is compiled into every program, so its contents matter, not just its timestamp
+	hashField(hash, readFile("src/Builtins.c"));
+	hashField(hash, readFile("src/Builtins.h"));
+
+	for (auto flag : flags) {
+		hashField(hash, flag);
+	}
+	for (auto input : inputs) {
+		hashField(hash, input + " " + toolVersion(input));
+	}
+
+	static const char *hex = "0123456789abcdef";
+	key = "";
+	for (int shift = 124; shift >= 0; shift -= 4) {
+		key += hex[(int) (hash >> shift) & 0xf];
+	}
+	// like ccache, split on the first two characters so no directory gets too big
+	entry = dir + "/" + key.substr(0, 2) + "/" + key.substr(2);
+}
+
+bool Cache::lookup() {
+	struct stat st;
+	if (stat((entry + "/QuackOutput").c_str(), &st) != 0) {
+		bumpStat("misses");
+		return false;
+	}
+
+	for (auto name : listDir(entry)) {
+		if (!copyFile(entry + "/" + name, name)) {
+			bumpStat("misses");
+			return false;
+		}
+	}
+
+	// touching the entry is what keeps it from being evicted
+	utime(entry.c_str(), nullptr);
+	bumpStat("hits");
+	return true;
+}
+
+void Cache::store(std::vector<std::string> files) {
+	makeDirs(dir + "/" + key.substr(0, 2));
+
+	// fill in a private directory first, so that a qcc running alongside
+	// this one never sees a half-written entry
+	std::string tmp = entry + ".tmp" + std::to_string(getpid());
+	if (mkdir(tmp.c_str(), 0755) != 0) return;
+	for (auto file : files) {
+		std::string name = file.substr(file.rfind('/') + 1);
+		if (!copyFile(file, tmp + "/" + name)) {
+			removeDir(tmp);
+			return;
+		}
+	}
+	if (rename(tmp.c_str(), entry.c_str()) != 0) {
+		// someone else stored the same build first
+		removeDir(tmp);
+		return;
+	}
+
+	evict();
+}
+
+void Cache::printStats() {
+	std::map<std::string, long long> stats;
+	std::stringstream lines(readFile(dir + "/stats"));
+	std::string which;
+	long long count;
+	while (lines >> which >> count) {
+		stats[which] = count;
+	}
+
+	long long entries = 0;
+	long long size = 0;
+	for (auto prefix : listDir(dir)) {
+		if (prefix == "stats") continue;
+		for (auto name : listDir(dir + "/" + prefix)) {
+			++entries;
+			size += dirSize(dir + "/" + prefix + "/" + name);
+		}
+	}
+
+	std::cout << "cache directory: " << dir << std::endl;
+	std::cout << "hits: " << stats["hits"] << std::endl;
+	std::cout << "misses: " << stats["misses"] << std::endl;
+	std::cout << "entries: " << entries << std::endl;
+	std::cout << "size: " << size / 1024 << " KB of " << maxBytes / 1024 << " KB" << std::endl;
+}
+
+std::string Cache::toolVersion(std::string path) {
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0) {
+		return "missing";
+	}
+	return std::to_string(st.st_size) + " " + std::to_string(st.st_mtim.tv_sec) + "." + std::to_string(st.st_mtim.tv_nsec);
+}
+
+std::string Cache::readFile(std::string path) {
+	std::ifstream in(path, std::ios::binary);
+	std::stringstream contents;
+	contents << in.rdbuf();
+	return contents.str();
+}
+
+// copies through a temporary and renames over the destination, which works even
+// if the destination is a program that's currently running
+bool Cache::copyFile(std::string from, std::string to) {
+	struct stat st;
+	if (stat(from.c_str(), &st) != 0) return false;
+
+	std::string tmp = to + ".tmp" + std::to_string(getpid());
+	{
+		std::ifstream in(from, std::ios::binary);
+		std::ofstream out(tmp, std::ios::binary);
+		out << in.rdbuf();
+		if (!in || !out) {
+			unlink(tmp.c_str());
+			return false;
+		}
+	}
+	chmod(tmp.c_str(), st.st_mode & 0777);
+	return rename(tmp.c_str(), to.c_str()) == 0;
+}
+
+// the counters live in a small text file, locked so that parallel builds don't lose counts
+void Cache::bumpStat(std::string which) {
+	makeDirs(dir);
+	int fd = open((dir + "/stats").c_str(), O_RDWR | O_CREAT, 0644);
+	if (fd < 0) return;
+	flock(fd, LOCK_EX);
+
+	std::string contents;
+	char buffer[256];
+	ssize_t n;
+	while ((n = read(fd, buffer, sizeof buffer)) > 0) {
+		contents.append(buffer, n);
+	}
+
+	std::map<std::string, long long> stats = {{"hits", 0}, {"misses", 0}};
+	std::stringstream lines(contents);
+	std::string name;
+	long long count;
+	while (lines >> name >> count) {
+		stats[name] = count;
+	}
+	++stats[which];
+
+	std::string updated;
+	for (auto counter : stats) {
+		updated += counter.first + " " + std::to_string(counter.second) + "\n";
+	}
+	ftruncate(fd, 0);
+	pwrite(fd, updated.data(), updated.size(), 0);
+
+	flock(fd, LOCK_UN);
+	close(fd);
+}
+
+// throw out the least recently used entries until the cache is back under 90% of its limit
+void Cache::evict() {
+	struct Entry {
+		time_t used;
+		std::string path;
+		long long size;
+	};
+	std::vector<Entry> entries;
+	long long total = 0;
+
+	for (auto prefix : listDir(dir)) {
+		if (prefix == "stats") continue;
+		for (auto name : listDir(dir + "/" + prefix)) {
+			std::string path = dir + "/" + prefix + "/" + name;
+			struct stat st;
+			if (name.find(".tmp") != std::string::npos || stat(path.c_str(), &st) != 0) {
+				continue;
+			}
+			long long size = dirSize(path);
+			entries.push_back({st.st_mtime, path, size});
+			total += size;
+		}
+	}
+	if (total <= maxBytes) return;
+
+	std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.used < b.used; });
+	for (auto &old : entries) {
+		if (total <= maxBytes / 10 * 9) break;
+		removeDir(old.path);
+		total -= old.size;
+	}
+}
@@ -0,0 +1,60 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <string>
+#include <vector>
+
+// A ccache-style cache of finished builds. Everything that can change what a
+// build produces (the program's AST, qcc and gcc themselves, Builtins, and the
+// flags) is hashed into a key, and each key's output files are kept in their
+// own directory under the cache directory. Entries are evicted least recently
+// used first once the cache grows past its size limit.
+class Cache {
+	public:
+        /* ============ */
+        /* Data Members */
+        /* ============ */
+
+        // where entries live, and how big the cache may get before evicting
+        std::string dir;
+        long long maxBytes;
+
+        // the hex digest identifying this build, and where its entry lives
+        std::string key;
+        std::string entry;
+
+        /* ========================== */
+        /* Constructors & Destructors */
+        /* ========================== */
+
+        // the directory comes from QCC_CACHE_DIR, then XDG_CACHE_HOME/qcc, then
+        // ~/.cache/qcc; the size limit (in MB) from QCC_CACHE_SIZE, default 512
+        Cache();
+        virtual ~Cache() { };
+
+        /* ======= */
+        /* Methods */
+        /* ======= */
+
+        // compute the key from the program's AST (from Node::serialize, which keeps children in
+        // source order; the JSON groups them by type, so two different programs can print the
+        // same), the flags that affect the output, and any other files the build reads (like a
+        // prebuilt runtime)
+        void computeKey(const std::string &program, std::vector<std::string> flags, std::vector<std::string> inputs);
+        // on a hit, copy the entry's files into the working directory and return true
+        bool lookup();
+        // save the build's files (relative to the working directory) under the key
+        void store(std::vector<std::string> files);
+        // print hits, misses, and how full the cache is
+        void printStats();
+
+	private:
+        // helper functions for the cache
+        std::string toolVersion(std::string path);
+        std::string readFile(std::string path);
+        bool copyFile(std::string from, std::string to);
+        void bumpStat(std::string which);
+        void evict();
+};
+
+#endif
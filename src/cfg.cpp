@@ -0,0 +1,157 @@
+#include <algorithm>
+#include "cfg.h"
+
+ControlFlowGraph::ControlFlowGraph(const std::vector<AST::Node*> &stmts) {
+	entry = newBlock();
+	BasicBlock *last = entry;
+	for (AST::Node *stmt : stmts) {
+		last = build(stmt, last);
+	}
+
+	// falling off the end of the method goes to the exit too
+	exit = newBlock();
+	for (BasicBlock *ret : returns) {
+		edge(ret, exit);
+	}
+	edge(last, exit);
+
+	reachable.assign(blocks.size(), false);
+	std::vector<BasicBlock*> stack(1, entry);
+	reachable[entry->id] = true;
+	while (!stack.empty()) {
+		BasicBlock *block = stack.back();
+		stack.pop_back();
+		for (BasicBlock *succ : block->succs) {
+			if (!reachable[succ->id]) {
+				reachable[succ->id] = true;
+				stack.push_back(succ);
+			}
+		}
+	}
+}
+
+BasicBlock *ControlFlowGraph::blockOf(AST::Node *stmt) const {
+	auto block = stmtBlocks.find(stmt);
+	return (block == stmtBlocks.end()) ? NULL : block->second;
+}
+
+BasicBlock *ControlFlowGraph::joinOf(AST::Node *stmt) const {
+	auto block = joins.find(stmt);
+	return (block == joins.end()) ? NULL : block->second;
+}
+
+std::vector<BasicBlock*> ControlFlowGraph::reversePostorder() const {
+	std::vector<BasicBlock*> order;
+	std::vector<bool> seen(blocks.size(), false);
+
+	// depth first from the entry, without recursing (a method can be long)
+	std::vector<std::pair<BasicBlock*, size_t> > stack;
+	stack.push_back(std::make_pair(entry, (size_t) 0));
+	seen[entry->id] = true;
+	while (!stack.empty()) {
+		BasicBlock *block = stack.back().first;
+		size_t next = stack.back().second;
+		if (next < block->succs.size()) {
+			stack.back().second++;
+			BasicBlock *succ = block->succs[next];
+			if (!seen[succ->id]) {
+				seen[succ->id] = true;
+				stack.push_back(std::make_pair(succ, (size_t) 0));
+			}
+		} else {
+			order.push_back(block);
+			stack.pop_back();
+		}
+	}
+	std::reverse(order.begin(), order.end());
+
+	for (auto &block : blocks) {
+		if (!seen[block->id]) order.push_back(block.get());
+	}
+	return order;
+}
+
+BasicBlock *ControlFlowGraph::newBlock() {
+	blocks.emplace_back(new BasicBlock());
+	blocks.back()->id = (int) blocks.size() - 1;
+	return blocks.back().get();
+}
+
+void ControlFlowGraph::edge(BasicBlock *from, BasicBlock *to) {
+	from->succs.push_back(to);
+	to->preds.push_back(from);
+}
+
+void ControlFlowGraph::add(BasicBlock *block, AST::Node *stmt) {
+	block->stmts.push_back(stmt);
+	stmtBlocks[stmt] = block;
+}
+
+BasicBlock *ControlFlowGraph::buildAll(const AST::NodeList &stmts, BasicBlock *current) {
+	for (AST::Node *stmt : stmts) {
+		current = build(stmt, current);
+	}
+	return current;
+}
+
+// adds a statement onto the end of current, and gives back the block the code after it goes in
+BasicBlock *ControlFlowGraph::build(AST::Node *stmt, BasicBlock *current) {
+	if (stmt->type == IF) {
+		// an elif is an if on its own in the false statements
+		add(current, stmt->get(COND));
+		BasicBlock *trueBlock = newBlock();
+		edge(current, trueBlock);
+		BasicBlock *trueEnd = buildAll(stmt->get(BLOCK, TRUE_STATEMENTS)->rawChildren, trueBlock);
+		BasicBlock *falseBlock = newBlock();
+		edge(current, falseBlock);
+		BasicBlock *falseEnd = buildAll(stmt->get(BLOCK, FALSE_STATEMENTS)->rawChildren, falseBlock);
+
+		BasicBlock *join = newBlock();
+		edge(trueEnd, join);
+		edge(falseEnd, join);
+		joins[stmt] = join;
+		return join;
+	}
+	else if (stmt->type == WHILE) {
+		BasicBlock *head = newBlock();
+		edge(current, head);
+		add(head, stmt->get(COND));
+		BasicBlock *body = newBlock();
+		edge(head, body);
+		BasicBlock *bodyEnd = buildAll(stmt->get(BLOCK, STATEMENTS)->rawChildren, body);
+		edge(bodyEnd, head);
+
+		BasicBlock *after = newBlock();
+		edge(head, after);
+		joins[stmt] = head;
+		return after;
+	}
+	else if (stmt->type == TYPECASE) {
+		// the value switched on, then one block per alternative, starting with the
+		// alternative itself (which assigns the variable). if none match, nothing runs
+		add(current, stmt->rawChildren[0]);
+		std::vector<BasicBlock*> ends;
+		for (AST::Node *alt : stmt->get(TYPE_ALTERNATIVES)->getAll(TYPE_ALTERNATIVE)) {
+			BasicBlock *altBlock = newBlock();
+			edge(current, altBlock);
+			add(altBlock, alt);
+			ends.push_back(buildAll(alt->get(BLOCK, STATEMENTS)->rawChildren, altBlock));
+		}
+
+		BasicBlock *after = newBlock();
+		edge(current, after);
+		for (BasicBlock *end : ends) {
+			edge(end, after);
+		}
+		joins[stmt] = after;
+		return after;
+	}
+	else if (stmt->type == RETURN) {
+		add(current, stmt);
+		returns.push_back(current);
+		return newBlock();
+	}
+
+	add(current, stmt);
+	return current;
+}
@@ -0,0 +1,72 @@
+#ifndef CFG_H
+#define CFG_H
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "ASTNode.h"
+
+// A straight run of a method's code, that control only enters at the top of and
+// leaves at the bottom of. Its statements are the simple ones: assignments,
+// expression statements, returns, the conditions of ifs and whiles, the value a
+// typecase switches on, and the typecase alternatives (which assign their variable).
+struct BasicBlock {
+        int id;
+        std::vector<AST::Node*> stmts;
+        std::vector<BasicBlock*> succs;
+        std::vector<BasicBlock*> preds;
+};
+
+// The control flow graph of a method's statements, built from the AST. Blocks are
+// numbered in the order their code comes in the method (the exit block comes last),
+// which is also the order a walk over the AST gets to them. A return goes straight
+// to the exit, so code after one is in a block nothing reaches.
+class ControlFlowGraph {
+	public:
+        /* ============ */
+        /* Data Members */
+        /* ============ */
+
+        std::vector<std::unique_ptr<BasicBlock> > blocks;
+        BasicBlock *entry;
+        BasicBlock *exit;
+
+        /* ========================== */
+        /* Constructors & Destructors */
+        /* ========================== */
+
+        explicit ControlFlowGraph(const std::vector<AST::Node*> &stmts);
+        virtual ~ControlFlowGraph() { };
+
+        /* ======= */
+        /* Methods */
+        /* ======= */
+
+        // the block a simple statement is in, or NULL for anything else
+        BasicBlock *blockOf(AST::Node *stmt) const;
+
+        // where the paths through an if, while or typecase come back together. for a
+        // while that's the block with the loop test, which the end of the body goes back to
+        BasicBlock *joinOf(AST::Node *stmt) const;
+
+        // the blocks in reverse postorder from the entry (the ones nothing reaches go last),
+        // the order that gets a forward dataflow problem done in the fewest passes
+        std::vector<BasicBlock*> reversePostorder() const;
+
+        // whether control can get to a block at all
+        bool isReachable(BasicBlock *block) const { return reachable[block->id]; }
+
+	private:
+        std::unordered_map<AST::Node*, BasicBlock*> stmtBlocks;
+        std::unordered_map<AST::Node*, BasicBlock*> joins;
+        std::vector<BasicBlock*> returns;
+        std::vector<bool> reachable;
+
+        BasicBlock *newBlock();
+        void edge(BasicBlock *from, BasicBlock *to);
+        void add(BasicBlock *block, AST::Node *stmt);
+        BasicBlock *build(AST::Node *stmt, BasicBlock *current);
+        BasicBlock *buildAll(const AST::NodeList &stmts, BasicBlock *current);
+};
+
+#endif
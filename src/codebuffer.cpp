@@ -0,0 +1,127 @@
+#include "codebuffer.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+void CodeBuffer::append(const char *text, size_t length) {
+	if (length == 0) {
+		return;
+	}
+	if (depth == 0) {
+		appendRaw(text, length);
+		lineStart = (text[length - 1] == '\n');
+		return;
+	}
+
+	// indented: put the tabs in front of each line that has something on it
+	const char *end = text + length;
+	while (text < end) {
+		const char *newline = (const char *) std::memchr(text, '\n', end - text);
+		const char *lineEnd = newline ? newline : end;
+		if (lineStart && lineEnd > text) {
+			for (int tab = 0; tab < depth; tab++) {
+				appendRaw("\t", 1);
+			}
+		}
+		appendRaw(text, lineEnd - text);
+		lineStart = false;
+		if (newline) {
+			appendRaw("\n", 1);
+			lineStart = true;
+		}
+		text = newline ? newline + 1 : end;
+	}
+}
+
+CodeBuffer &CodeBuffer::operator<<(const char *text) {
+	append(text, std::strlen(text));
+	return *this;
+}
+
+// another buffer's text, for putting together pieces that were generated separately
+CodeBuffer &CodeBuffer::operator<<(const CodeBuffer &other) {
+	for (size_t i = 0; i < other.chunks.size(); i++) {
+		append(other.chunks[i].get(), (i + 1 == other.chunks.size()) ? other.used : chunkSize);
+	}
+	return *this;
+}
+
+size_t CodeBuffer::size() const {
+	return chunks.empty() ? 0 : (chunks.size() - 1) * chunkSize + used;
+}
+
+std::string CodeBuffer::str() const {
+	std::string text;
+	text.reserve(size());
+	for (size_t i = 0; i < chunks.size(); i++) {
+		text.append(chunks[i].get(), (i + 1 == chunks.size()) ? used : chunkSize);
+	}
+	return text;
+}
+
+bool CodeBuffer::writeFile(const std::string &path) const {
+	int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		return false;
+	}
+	bool written = writeTo(fd);
+	return (close(fd) == 0) && written;
+}
+
+// one writev for all the chunks (a few, if there are more chunks than writev takes at once)
+bool CodeBuffer::writeTo(int fd) const {
+	std::vector<struct iovec> pieces;
+	for (size_t i = 0; i < chunks.size(); i++) {
+		pieces.push_back({chunks[i].get(), (i + 1 == chunks.size()) ? used : chunkSize});
+	}
+
+	size_t next = 0;
+	while (next < pieces.size()) {
+		int count = (int) std::min(pieces.size() - next, (size_t) IOV_MAX);
+		ssize_t written = writev(fd, &pieces[next], count);
+		if (written < 0) {
+			return false;
+		}
+		// skip what made it out, and pick up partway through a piece if the write stopped there
+		while (next < pieces.size() && (size_t) written >= pieces[next].iov_len) {
+			written -= pieces[next].iov_len;
+			++next;
+		}
+		if (next < pieces.size()) {
+			pieces[next].iov_base = (char *) pieces[next].iov_base + written;
+			pieces[next].iov_len -= written;
+		}
+	}
+	return true;
+}
+
+void CodeBuffer::appendRaw(const char *text, size_t length) {
+	while (length > 0) {
+		if (used == chunkSize) {
+			chunks.emplace_back(new char[chunkSize]);
+			used = 0;
+		}
+		size_t room = std::min(length, chunkSize - used);
+		std::memcpy(chunks.back().get() + used, text, room);
+		used += room;
+		text += room;
+		length -= room;
+	}
+}
+
+void CodeBuffer::appendNumber(long long n) {
+	char digits[24];
+	char *start = digits + sizeof digits;
+	unsigned long long magnitude = (n < 0) ? 0ULL - (unsigned long long) n : (unsigned long long) n;
+	do {
+		*--start = (char) ('0' + magnitude % 10);
+		magnitude /= 10;
+	} while (magnitude > 0);
+	if (n < 0) {
+		*--start = '-';
+	}
+	append(start, digits + sizeof digits - start);
+}
@@ -0,0 +1,62 @@
+#ifndef CODEBUFFER_H
+#define CODEBUFFER_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// An append-only buffer that the code generator writes C into. Text is copied
+// into large fixed-size chunks that never move once written (so appending never
+// reallocates or copies what's already there), and nothing touches the disk
+// until the whole file is written out with a single call.
+class CodeBuffer {
+	public:
+        /* ========================== */
+        /* Constructors & Destructors */
+        /* ========================== */
+
+        CodeBuffer() { };
+        virtual ~CodeBuffer() { };
+
+        /* ======= */
+        /* Methods */
+        /* ======= */
+
+        // appending text. newlines are plain '\n', there's no flushing to go with them
+        void append(const char *text, size_t length);
+        CodeBuffer &operator<<(const std::string &text) { append(text.data(), text.size()); return *this; }
+        CodeBuffer &operator<<(const char *text);
+        CodeBuffer &operator<<(char c) { append(&c, 1); return *this; }
+        CodeBuffer &operator<<(const CodeBuffer &other);
+
+        // any kind of integer, like temp and label numbers
+        template <typename Number, typename = typename std::enable_if<std::is_integral<Number>::value>::type>
+        CodeBuffer &operator<<(Number n) { appendNumber((long long) n); return *this; }
+
+        // indentation: every line started while the depth is above zero begins with that many tabs
+        void indent() { ++depth; }
+        void dedent() { if (depth > 0) --depth; }
+
+        // how much has been written, and all of it as one string (for handing to something in memory)
+        size_t size() const;
+        std::string str() const;
+
+        // write everything out in one go. returns false if the file couldn't be written
+        bool writeFile(const std::string &path) const;
+        bool writeTo(int fd) const;
+
+	private:
+        static const size_t chunkSize = 64 * 1024;
+
+        std::vector<std::unique_ptr<char[]>> chunks;
+        size_t used = chunkSize; // bytes used in the last chunk; full means a new one is needed
+        int depth = 0;
+        bool lineStart = true;
+
+        void appendRaw(const char *text, size_t length);
+        void appendNumber(long long n);
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include "codegen.h"
 #include "cstring"
+#include <cstdio>
 
 bool CodeGenerator::generate() {
 	primitives.push_back("String");
@@ -8,10 +9,17 @@ bool CodeGenerator::generate() {
 	primitives.push_back("Obj");
 	primitives.push_back("Nothing");
 
-	std::ofstream fout(filename);
+	generateFunctions();
+	if (split) {
+		return generateSplit();
+	}
+
+	// the whole file is put together in memory, and written out at the end
+	CodeBuffer fout;
 
 	// include the built-in functions and classes provided by Professor Young
-	fout << "#include \"src/Builtins.h\"" << indent;
+	fout << "#include \"src/Builtins.h\"" << blankLine;
+	generateProfileDecl(fout);
 
     bool classesGenerated = this->generateClasses(fout);
     if (!classesGenerated) {
@@ -22,6 +30,7 @@ bool CodeGenerator::generate() {
     }
 
 	bool mainGenerated = this->generateMain(fout);
+	generateProfileDump(fout);
     if (!mainGenerated) {
     	report::error("code for main method could not be generated!", CODEGENERATION);
         report::dynamicBail();
@@ -29,9 +38,209 @@ bool CodeGenerator::generate() {
         report::gnote("code for main method successfully generated.", CODEGENERATION);
     }
 
+	return writeOut(fout, filename);
+}
+
+// the same code as generate(), spread over a shared header, one .c file per class
+// and one for main, so that the C compiler can work on them in parallel
+bool CodeGenerator::generateSplit() {
+	std::string base = filename.substr(0, filename.rfind(".c"));
+	std::string header = base + ".h";
+
+	// everything the classes need to know about each other goes in the header
+	CodeBuffer hout;
+	hout << "#ifndef QUACK_OUTPUT_H" << '\n';
+	hout << "#define QUACK_OUTPUT_H" << blankLine;
+	hout << "#include \"src/Builtins.h\"" << blankLine;
+	generateProfileDecl(hout);
+	generateTypedefs(hout);
+	generateForwardDecls(hout);
+	generateExterns(hout);
+	generateStructs(hout);
+	hout << "#endif" << '\n';
+	if (!writeOut(hout, header)) {
+		return false;
+	}
+
+	// then each class gets its constructor, methods, and singleton in its own file
+	for (auto qclass : this->classes) {
+		auto currentClass = qclass.second;
+		std::string name = currentClass->name;
+		if (checkPrimitive(name)) {
+			continue;
+		}
+		std::string classFile = base + "_" + name + ".c";
+		CodeBuffer classOut;
+		classOut << "#include \"" << header << "\"" << blankLine;
+		classOut << functionCode[currentClass->constructor];
+		generateClassMethods(classOut, currentClass);
+		generateSingleton(classOut, currentClass);
+		if (!writeOut(classOut, classFile)) {
+			return false;
+		}
+		sourceFiles.push_back(classFile);
+	}
+
+	CodeBuffer fout;
+	fout << "#include \"" << header << "\"" << blankLine;
+	bool mainGenerated = this->generateMain(fout);
+	generateProfileDump(fout);
+	if (!mainGenerated) {
+		report::error("code for main method could not be generated!", CODEGENERATION);
+		report::dynamicBail();
+	} else if (report::ok()) {
+		report::gnote("code for classes and main method successfully generated.", CODEGENERATION);
+	}
+	sourceFiles.push_back(filename);
+
+	return writeOut(fout, filename);
+}
+
+// writes a finished file to disk, reporting it if that didn't work
+bool CodeGenerator::writeOut(CodeBuffer &buffer, std::string path) {
+	if (!buffer.writeFile(path)) {
+		report::error("could not write " + path + "!", CODEGENERATION);
+		return false;
+	}
 	return true;
 }
 
+// reads the counts written by a -pgo=generate build. returns false if there is no profile
+bool CodeGenerator::loadProfile(std::string path) {
+	std::ifstream in(path);
+	profileUse = true;
+	if (!in.is_open()) {
+		return false;
+	}
+	std::string kind, site;
+	long long count;
+	while (in >> kind >> site >> count) {
+		// every run of the program appends its counts, so add them up
+		profileCounts[kind + " " + site] += count;
+	}
+	for (auto counter : profileCounts) {
+		if (counter.first.compare(0, 5, "call ") == 0) {
+			maxCalls = std::max(maxCalls, counter.second);
+		}
+	}
+	return true;
+}
+
+// with -pgo=generate, returns a statement that counts whatever label describes
+// (and registers the label so that it gets written out). otherwise returns ""
+std::string CodeGenerator::profileCounter(std::string label, bool before) {
+	if (!profileGenerate) {
+		return "";
+	}
+	std::string counter = "qk_profile[" + std::to_string(profileSites.size()) + "]++;";
+	profileSites.push_back(label);
+	return before ? counter + " " : " " + counter;
+}
+
+// with -pgo=use, marks functions that were never called during training as cold,
+// and ones that got at least a tenth as many calls as the busiest function as hot
+std::string CodeGenerator::profileAttribute(const FunctionContext &fn) {
+	auto counter = profileCounts.find("call " + fn.name);
+	if (!profileUse || counter == profileCounts.end()) {
+		return "";
+	}
+	if (counter->second == 0) {
+		return "__attribute__((cold)) ";
+	}
+	if (counter->second * 10 >= maxCalls) {
+		return "__attribute__((hot)) ";
+	}
+	return "";
+}
+
+// with -pgo=use, tells gcc which way a condition almost always went during training,
+// so that it lays out the likely path as the fall through
+std::string CodeGenerator::profileBranch(std::string cond, std::string site) {
+	if (!profileUse) {
+		return cond;
+	}
+	long long taken = profileCount("taken " + site);
+	long long total = taken + profileCount("nottaken " + site);
+	if (total == 0) {
+		return cond;
+	}
+	if (taken * 10 >= total * 9) {
+		return "__builtin_expect(" + cond + ", 1)";
+	}
+	if (taken * 10 <= total) {
+		return "__builtin_expect(" + cond + ", 0)";
+	}
+	return cond;
+}
+
+// the count recorded for a site, 0 if it never showed up
+long long CodeGenerator::profileCount(const std::string &site) {
+	auto counter = profileCounts.find(site);
+	return (counter == profileCounts.end()) ? 0 : counter->second;
+}
+
+// both -pgo builds declare the counters on the same line, so that the functions
+// line up between the two and gcc can match its own profile to them
+void CodeGenerator::generateProfileDecl(CodeBuffer &output) {
+	if (profileGenerate || profileUse) {
+		output << "extern long long qk_profile[];" << blankLine;
+	}
+}
+
+// text as a C string literal, quotes included. a path can have anything in it
+static std::string cStringLiteral(const std::string &text) {
+	std::string literal = "\"";
+	for (unsigned char c : text) {
+		// ? too, so that two of them can't make a trigraph
+		if (c == '"' || c == '\\' || c == '?') {
+			literal += '\\';
+			literal += c;
+		} else if (c < ' ' || c == 0x7f) {
+			// always three digits, so a digit after it can't run on into it
+			char octal[5];
+			snprintf(octal, sizeof(octal), "\\%03o", c);
+			literal += octal;
+		} else {
+			literal += c;
+		}
+	}
+	return literal + "\"";
+}
+
+// the counters, and a function that appends them to the profile when the program exits
+void CodeGenerator::generateProfileDump(CodeBuffer &output) {
+	if (!profileGenerate) {
+		return;
+	}
+	output << '\n' << "// -~-~-~-~- Profile Counters -~-~-~-~-" << '\n';
+	output << "#include <stdio.h>" << '\n' << "#include <stdlib.h>" << '\n';
+	output << "long long qk_profile[" << profileSites.size() + 1 << "];" << '\n';
+	output << "static const char *qk_profile_sites[] = {" << '\n';
+	output.indent();
+	for (auto site : profileSites) {
+		output << "\"" << site << "\"," << '\n';
+	}
+	output.dedent();
+	output << "};" << '\n';
+	output << "static void qk_profile_dump(void) {" << '\n';
+	output.indent();
+	output << "FILE *out = fopen(" << cStringLiteral(profilePath) << ", \"a\");" << '\n';
+	output << "if (!out) return;" << '\n';
+	output << "for (int i = 0; i < " << profileSites.size() << "; i++) {" << '\n';
+	output.indent();
+	output << "fprintf(out, \"%s %lld\\n\", qk_profile_sites[i], qk_profile[i]);" << '\n';
+	output.dedent();
+	output << "}" << '\n';
+	output << "fclose(out);" << '\n';
+	output.dedent();
+	output << "}" << '\n';
+	output << "__attribute__((constructor)) static void qk_profile_start(void) {" << '\n';
+	output.indent();
+	output << "atexit(qk_profile_dump);" << '\n';
+	output.dedent();
+	output << "}" << '\n';
+}
+
 bool CodeGenerator::checkPrimitive(std::string name) {
 	if (std::find(primitives.begin(), primitives.end(), name) != primitives.end()) {
 		return true;
@@ -39,7 +248,36 @@ bool CodeGenerator::checkPrimitive(std::string name) {
 	return false;
 }
 
-bool CodeGenerator::generateClasses(std::ostream &output) {
+// Int, String, Boolean, and Nothing can't be extended (see Typechecker::createQclass),
+// so an object whose static type is one of these is always exactly that class
+bool CodeGenerator::checkFinal(std::string name) {
+	if (name == "Int" || name == "String" || name == "Boolean" || name == "Nothing") {
+		return true;
+	}
+	return false;
+}
+
+// the C operator for an Int method that can be done on unboxed values, or "" if there isn't one
+std::string CodeGenerator::intOperator(std::string methodName) {
+	if (methodName == "PLUS") return "+";
+	if (methodName == "MINUS") return "-";
+	if (methodName == "TIMES") return "*";
+	if (methodName == "DIVIDE") return "/";
+	if (methodName == "LESSER") return "<";
+	if (methodName == "GREATER") return ">";
+	if (methodName == "ATMOST") return "<=";
+	if (methodName == "ATLEAST") return ">=";
+	if (methodName == "EQUALS") return "==";
+	return "";
+}
+
+// the type the typechecker left on a node. every expression codegen asks about was
+// visited by inference, so this is only "$UNKNOWN" where inference would say so too
+std::string CodeGenerator::staticType(AST::Node *node) {
+	return symbols.name((node->staticType != NO_SYMBOL) ? node->staticType : SYM_UNKNOWN);
+}
+
+bool CodeGenerator::generateClasses(CodeBuffer &output) {
 	// print out the typedef'd structs for every class
 	generateTypedefs(output);
 
@@ -60,13 +298,13 @@ bool CodeGenerator::generateClasses(std::ostream &output) {
 	generateSingletons(output);
 
 	// final whitespace!
-	output << indent;
+	output << blankLine;
 
 	return true;
 }
 
-void CodeGenerator::generateTypedefs(std::ostream &output) {
-	output << "// -~-~-~-~- Typedefs Begin -~-~-~-~-" << indent;
+void CodeGenerator::generateTypedefs(CodeBuffer &output) {
+	output << "// -~-~-~-~- Typedefs Begin -~-~-~-~-" << blankLine;
 	for (auto qclass : this->classes) {
 		auto currentClass = qclass.second;
 		std::string name = currentClass->name;
@@ -76,24 +314,24 @@ void CodeGenerator::generateTypedefs(std::ostream &output) {
 		} 
 
 		// output the definitions for this class
-		output << "// Class " << name << "'s typedefs" << std::endl;
-		output << "struct class_" << name << "_struct;" << std::endl;
+		output << "// Class " << name << "'s typedefs" << '\n';
+		output << "struct class_" << name << "_struct;" << '\n';
 
 		output << "typedef struct class_" << name << 
-		"_struct* class_"<< name << ";" << std::endl;
+		"_struct* class_"<< name << ";" << '\n';
 
-		output << "struct obj_" << name << "_struct;" << std::endl;
+		output << "struct obj_" << name << "_struct;" << '\n';
 
 		output << "typedef struct obj_" << name << 
-		"_struct* obj_"<< name << ";" << std::endl;
+		"_struct* obj_"<< name << ";" << '\n';
 
-		output << std::endl;
+		output << '\n';
 	}
-	output << "// -~-~-~-~- Typedefs End -~-~-~-~-" << indent;
+	output << "// -~-~-~-~- Typedefs End -~-~-~-~-" << blankLine;
 }
 
-void CodeGenerator::generateForwardDecls(std::ostream &output) {
-	output << "// -~-~-~-~- Forward Declarations Begin -~-~-~-~-" << std::endl;
+void CodeGenerator::generateForwardDecls(CodeBuffer &output) {
+	output << "// -~-~-~-~- Forward Declarations Begin -~-~-~-~-" << '\n';
 	for (auto qclass : this->classes) {
 		auto currentClass = qclass.second;
 		std::string name = currentClass->name;
@@ -101,10 +339,14 @@ void CodeGenerator::generateForwardDecls(std::ostream &output) {
 		if (checkPrimitive(name)) {
 			continue;
 		} 
-		output << "\n// Class " << name << "'s forward declarations" << std::endl;
-		output << "struct class_" << name << "_struct the_class_" << name << "_struct;" << std::endl;
+		output << "\n// Class " << name << "'s forward declarations" << '\n';
+		// with split output this is shared by every file, so it can only be defined once (by the singleton)
+		if (split) {
+			output << "extern ";
+		}
+		output << "struct class_" << name << "_struct the_class_" << name << "_struct;" << '\n';
 		output << "obj_" << name << " new_" << name << "(";
-		i = 0;
+		int i = 0;
 		for (auto constructArg : constructor->argtype) {
 			if (constructArg.second == name) {
 				continue;
@@ -116,7 +358,7 @@ void CodeGenerator::generateForwardDecls(std::ostream &output) {
 				output << ", obj_" << constructArg.second << " " << constructArg.first;
 			}
 		}
-		output << ");" << std::endl;
+		output << ");" << '\n';
 		for (auto method : currentClass->methods) {
 			std::string returnType = method->type["return"];
 			std::string methodName = method->name;
@@ -141,14 +383,14 @@ void CodeGenerator::generateForwardDecls(std::ostream &output) {
 					output << ", obj_" << arg.second << " " << arg.first;
 				}
 			}
-			output << ");" << std::endl;
+			output << ");" << '\n';
 		}
 	}
-	output << "\n// -~-~-~-~- Forward Declarations End -~-~-~-~-" << indent;
+	output << "\n// -~-~-~-~- Forward Declarations End -~-~-~-~-" << blankLine;
 }
 
-void CodeGenerator::generateStructs(std::ostream &output) {
-	output << "// -~-~-~-~- Structs Begin -~-~-~-~-" << indent;
+void CodeGenerator::generateStructs(CodeBuffer &output) {
+	output << "// -~-~-~-~- Structs Begin -~-~-~-~-" << blankLine;
 	for (auto qclass : this->classes) {
 		auto currentClass = qclass.second;
 		std::string name = currentClass->name;
@@ -160,28 +402,29 @@ void CodeGenerator::generateStructs(std::ostream &output) {
 		if (std::find(printedClasses.begin(), printedClasses.end(), currentClass->super) == printedClasses.end()) {
 			if (!checkPrimitive(currentClass->super)) {
 				generateStruct(output, this->classes[currentClass->super]);
-				generateConstructor(output, this->classes[currentClass->super]);
+				if (!split) output << functionCode[this->classes[currentClass->super]->constructor];
 				printedClasses.push_back(currentClass->super);
 			}
 		}
 		// if the class hasn't been printed yet, then print it
 		if (std::find(printedClasses.begin(), printedClasses.end(), currentClass->name) == printedClasses.end()) {
 			generateStruct(output, currentClass);
-			generateConstructor(output, currentClass);
+			if (!split) output << functionCode[currentClass->constructor];
 			printedClasses.push_back(name);
 		}
 	}
-	output << "// -~-~-~-~- Structs End -~-~-~-~-" << indent;
+	output << "// -~-~-~-~- Structs End -~-~-~-~-" << blankLine;
 }
 
-void CodeGenerator::generateStruct(std::ostream &output, Qclass *whichClass) {
+void CodeGenerator::generateStruct(CodeBuffer &output, Qclass *whichClass) {
 	auto currentClass = whichClass;
 	std::string name = currentClass->name;
 	Qmethod *constructor = currentClass->constructor;
 
 	// output the struct obj_CLASSNAME_struct with fields and clazz pointer
-	output << "typedef struct obj_" << name << "_struct {" << std::endl;
-	output << "\tclass_" << name << " clazz;" << std::endl;
+	output << "typedef struct obj_" << name << "_struct {" << '\n';
+	output.indent();
+	output << "class_" << name << " clazz;" << '\n';
 
 	// vector of fields we've already printed
 	std::vector<std::string> printedFields;
@@ -192,7 +435,7 @@ void CodeGenerator::generateStruct(std::ostream &output, Qclass *whichClass) {
 			std::string fieldType = currentClass->instanceVarType[field];
 			if (field == superField) {
 				if (std::find(printedFields.begin(), printedFields.end(), field) == printedFields.end()) {
-					output << "\tobj_" << fieldType << " " << field << ";" << std::endl;
+					output << "obj_" << fieldType << " " << field << ";" << '\n';
 					printedFields.push_back(field);
 					fieldGenerationOrder[name].push_back(field);
 				}
@@ -205,21 +448,23 @@ void CodeGenerator::generateStruct(std::ostream &output, Qclass *whichClass) {
 		std::string fieldType = currentClass->instanceVarType[field];
 		if (field != "this") {
 			if (std::find(printedFields.begin(), printedFields.end(), field) == printedFields.end()) {
-				output << "\tobj_" << fieldType << " " << field << ";" << std::endl;
+				output << "obj_" << fieldType << " " << field << ";" << '\n';
 				printedFields.push_back(field);
 				fieldGenerationOrder[name].push_back(field);
 			}
 		}
 	}
-	output << "} * obj_" << name << ";" << indent;
+	output.dedent();
+	output << "} * obj_" << name << ";" << blankLine;
 
 	// output the "struct class_CLASSNAME_struct"
-	output << "struct class_" << name << "_struct {" << std::endl;
-	output << "\tclass_Obj super_;" << std::endl;
-	output << "\t// Method Table - constructor comes first" << std::endl;
+	output << "struct class_" << name << "_struct {" << '\n';
+	output.indent();
+	output << "class_Obj super_;" << '\n';
+	output << "// Method Table - constructor comes first" << '\n';
 
 	// print the constructor, which is a special method not inside "methods" vector
-	output << "\tobj_" << name << " (*constructor) (";
+	output << "obj_" << name << " (*constructor) (";
 
 	int i = 0;
 	for (auto constructArg : constructor->argtype) {
@@ -233,101 +478,50 @@ void CodeGenerator::generateStruct(std::ostream &output, Qclass *whichClass) {
 			output << ", obj_" << constructArg.second;
 		}
 	}
-	output << ");" << std::endl;
+	output << ");" << '\n';
 
 	// print out all methods, this includes inherited & overriden ones
-	if (checkPrimitive(currentClass->super)) {
-		methodOrderer(output, this->classes[currentClass->super]->methods, currentClass);
-	} else {
-		methodOrderer(output, this->methodGenerationOrder[currentClass->super], currentClass);
-	}
+	generateMethodTable(output, currentClass);
 }
 
-void CodeGenerator::methodOrderer(std::ostream &output, std::vector<Qmethod *> whereToLook, Qclass *currentClass) {
-	std::string name = currentClass->name;
-	Qmethod *constructor = currentClass->constructor;
-
-	// vector of methods we've already printed
-	std::vector<std::string> printedMethods;
-	// vector of names of our methods to check against super classes
-	std::vector<std::string> methodNames;
-	for (auto method : currentClass->methods) {
-		methodNames.push_back(method->name);
-	}
-
-	// print the super methods
-	for (auto superMethod : whereToLook) {
-		// check if the super method is in this class' methods, if it's overriden
-		if (std::find(methodNames.begin(), methodNames.end(), superMethod->name) != methodNames.end()) {
-			// look for the method that has the same name as the super method
-			for (auto method : currentClass->methods) {
-				if (method->name == superMethod->name) {
-					if (std::find(printedMethods.begin(), printedMethods.end(), method->name) == printedMethods.end()) {
-						output << "\tobj_" << method->type["return"] << " (*" << method->name << ") (";
-						output << "obj_" << name;
-						for (auto arg : method->args) {
-							std::string argtype = method->argtype[arg];
-							if (method->argtype[arg] != "Nothing") {
-									output << ", obj_" << argtype;
-							} else {
-								output << "obj_" << name;
-							}
-						}
-						output << "); // overriden method" << std::endl;
-						printedMethods.push_back(method->name);
-						methodGenerationOrder[name].push_back(method);
-					}
-				}
-			}
-		} else {
-			output << "\tobj_" << superMethod->type["return"] << " (*" << superMethod->name << ") (";
-			output << "obj_" << currentClass->super;
-			for (auto arg : superMethod->args) {
-				std::string argtype = superMethod->argtype[arg];
-				if (superMethod->argtype[arg] != "Nothing") {
-						output << ", obj_" << argtype;
-				} else {
-					output << "obj_" << currentClass->super;
-				}
+// the method pointers in the class struct, one per slot of the class's method table
+void CodeGenerator::generateMethodTable(CodeBuffer &output, Qclass *currentClass) {
+	for (Qmethod *method : currentClass->vtable) {
+		bool inherited = (method->clazz != currentClass);
+		// an inherited method still takes the super's object as "this"
+		std::string self = inherited ? currentClass->super : currentClass->name;
+		output << "obj_" << method->type["return"] << " (*" << method->name << ") (";
+		output << "obj_" << self;
+		for (auto arg : method->args) {
+			std::string argtype = method->argtype[arg];
+			if (argtype != "Nothing") {
+					output << ", obj_" << argtype;
+			} else {
+				output << "obj_" << self;
 			}
-			output << "); // inherited from " << currentClass->super << std::endl;
-			printedMethods.push_back(superMethod->name);
-			currentClass->methods.push_back(superMethod);
-			methodGenerationOrder[name].push_back(superMethod);
-			classInherited[name].push_back(superMethod->name);
 		}
-	}
-
-	// print the rest of the class's methods
-	for (auto method : currentClass->methods) {
-		if (std::find(printedMethods.begin(), printedMethods.end(), method->name) == printedMethods.end()) {
-			output << "\tobj_" << method->type["return"] << " (*" << method->name << ") (";
-			output << "obj_" << name;
-			for (auto arg : method->args) {
-				std::string argtype = method->argtype[arg];
-				if (method->argtype[arg] != "Nothing") {
-						output << ", obj_" << argtype;
-				} else {
-					output << "obj_" << name;
-				}
-			}
-			output << ");" << std::endl;
-			printedMethods.push_back(method->name);
-			methodGenerationOrder[name].push_back(method);
+		if (inherited) {
+			output << "); // inherited from " << currentClass->super << '\n';
+		} else if (method->overrides != NULL) {
+			output << "); // overriden method" << '\n';
+		} else {
+			output << ");" << '\n';
 		}
 	}
-	output << "};" << indent;
+	output.dedent();
+	output << "};" << blankLine;
 }
 
-void CodeGenerator::generateConstructor(std::ostream &output, Qclass *currentClass) {
+void CodeGenerator::generateConstructor(CodeBuffer &output, Qclass *currentClass) {
 	std::string name = currentClass->name;
 	Qmethod *constructor = currentClass->constructor;
 
 	// time to print some methods!
 	// begin with the constructor...
-	output << "// " << name << "'s constructor method definition" << std::endl;
-	output << "obj_" << name << " new_" << name << "(";
-	i = 0;
+	output << "// " << name << "'s constructor method definition" << '\n';
+	FunctionContext fn("new_" + name);
+	output << profileAttribute(fn) << "obj_" << name << " new_" << name << "(";
+	int i = 0;
 	for (auto constructArg : constructor->argtype) {
 		if (constructArg.second == name) {
 			continue;
@@ -339,10 +533,11 @@ void CodeGenerator::generateConstructor(std::ostream &output, Qclass *currentCla
 			output << ", obj_" << constructArg.second << " " << constructArg.first;
 		}
 	}
-	output << ") {" << std::endl;
-	output << "\tobj_" << name << " this = (obj_" << name <<
-	") malloc(sizeof(struct obj_" << name << "_struct));" << std::endl;
-	output << "\tthis->clazz" << " = " << "the_class_" << name << ";" << std::endl;
+	output << ") {" << profileCounter("call " + fn.name) << '\n';
+	output.indent();
+	output << "obj_" << name << " this = (obj_" << name <<
+	") malloc(sizeof(struct obj_" << name << "_struct));" << '\n';
+	output << "this->clazz" << " = " << "the_class_" << name << ";" << '\n';
 	for (auto inited : constructor->type) {
 		if (inited.first == "return") {
 			continue;
@@ -350,16 +545,18 @@ void CodeGenerator::generateConstructor(std::ostream &output, Qclass *currentCla
 		if (std::find(constructor->args.begin(), constructor->args.end(), inited.first) != constructor->args.end()) {
 			continue;
 		}
-		output << "\tobj_" << inited.second << " " << inited.first << ";" << std::endl;
+		output << "obj_" << inited.second << " " << inited.first << ";" << '\n';
 	}
 	for (AST::Node *stmt : constructor->stmts) {
-		generateStatement(output, stmt, constructor, name);
+		generateStatement(output, fn, stmt, constructor, name);
 	}
-	output << "\treturn this;" << std::endl << "}" << indent;
+	output << "return this;" << '\n';
+	output.dedent();
+	output << "}" << blankLine;
 }
 
-void CodeGenerator::generateExterns(std::ostream &output) {
-	output << "// -~-~-~-~- Externs Begin -~-~-~-~-" << indent;
+void CodeGenerator::generateExterns(CodeBuffer &output) {
+	output << "// -~-~-~-~- Externs Begin -~-~-~-~-" << blankLine;
 	for (auto qclass : this->classes) {
 		auto currentClass = qclass.second;
 		std::string name = currentClass->name;
@@ -368,145 +565,175 @@ void CodeGenerator::generateExterns(std::ostream &output) {
 			continue;
 		} 
 
-		output << "extern class_" << name << " the_class_" << name << ";" << indent;
+		output << "extern class_" << name << " the_class_" << name << ";" << blankLine;
 	}
-	output << "// -~-~-~-~- Externs End -~-~-~-~-" << indent;
+	output << "// -~-~-~-~- Externs End -~-~-~-~-" << blankLine;
 }
 
-void CodeGenerator::generateMethods(std::ostream &output) {
-	output << "// -~-~-~-~- Methods Begin -~-~-~-~-" << indent;
+// Every constructor and method is generated before anything else, each into its own
+// buffer and with its own temps and labels, so they can be spread over the thread pool.
+// The finished functions are then spliced in wherever they go, in the same order as
+// always, so the output doesn't depend on how many threads there are. With
+// -pgo=generate the functions are done in order on this thread instead, since they
+// all number their counters from the one list.
+void CodeGenerator::generateFunctions() {
+	std::vector<Qmethod*> functions;
 	for (auto qclass : this->classes) {
 		auto currentClass = qclass.second;
-		std::string name = currentClass->name;
-		Qmethod *constructor = currentClass->constructor;
-		if (checkPrimitive(name)) {
+		if (checkPrimitive(currentClass->name)) {
 			continue;
 		}
+		functions.push_back(currentClass->constructor);
+		for (Qmethod *method : currentClass->methods) {
+			functions.push_back(method);
+		}
+	}
+	// the buffers exist before any thread starts, so the threads only ever look them up
+	for (Qmethod *function : functions) {
+		functionCode[function];
+	}
 
-		// time to print method definitions!
-		// ... the rest of the methods, at least
-		output << "// " << name << "'s other method definitions" << std::endl;
-		for (auto method : currentClass->methods) {
-			std::string returnType = method->type["return"];
-			std::string methodName = method->name;
+	std::vector<report::Diagnostics> diagnostics(functions.size());
+	auto generateFunction = [&](size_t k) {
+		Qmethod *function = functions[k];
+		CodeBuffer &output = functionCode.find(function)->second;
+		report::collect(&diagnostics[k]);
+		if (function == function->clazz->constructor) {
+			generateConstructor(output, function->clazz);
+		} else {
+			generateMethod(output, function);
+		}
+		report::collect(NULL);
+	};
+	if (profileGenerate) {
+		for (size_t k = 0; k < functions.size(); k++) {
+			generateFunction(k);
+		}
+	} else {
+		this->tc->pool.forEach(functions.size(), generateFunction);
+	}
 
-			auto it = std::find(classInherited[name].begin(), classInherited[name].end(), method->name);
+	for (report::Diagnostics &d : diagnostics) {
+		d.replay();
+	}
+}
 
-			if (it != classInherited[name].end()) {
-				continue;
-			}
+void CodeGenerator::generateMethods(CodeBuffer &output) {
+	output << "// -~-~-~-~- Methods Begin -~-~-~-~-" << blankLine;
+	for (auto qclass : this->classes) {
+		auto currentClass = qclass.second;
+		if (checkPrimitive(currentClass->name)) {
+			continue;
+		}
+		generateClassMethods(output, currentClass);
+	}
+	output << "// -~-~-~-~- Methods End -~-~-~-~-" << blankLine;
+}
 
-			output << "obj_" << returnType << " " << name << "_method_" << methodName << "(";
-			i = 0;
+void CodeGenerator::generateClassMethods(CodeBuffer &output, Qclass *currentClass) {
+	std::string name = currentClass->name;
 
-			if (method->argtype.size() == 1) {
-				output << "obj_" << name << " this";
-			} else {
-				output << "obj_" << name << " this, ";
-			}
-			for (auto arg : method->argtype) {
-				if (arg.first == "Nothing" || arg.first == "return") {
-					output << "";
-					continue;
-				}
-				if (i == 0) {
-					output << "obj_" << arg.second << " " << arg.first;
-					++i;
-				} else {
-					output << ", obj_" << arg.second << " " << arg.first;
-				}
-			}
-			output << ")" << " {" << std::endl;
-			for (auto inited : method->type) {
-				if (inited.first == "return") {
-					continue;
-				}
-				if (std::find(method->args.begin(), method->args.end(), inited.first) != method->args.end()) {
-					continue;
-				}
-				output << "\tobj_" << inited.second << " " << inited.first << ";" << std::endl;
-			}
-			for (AST::Node *stmt : method->stmts) {
-				generateStatement(output, stmt, method, name);
-			}
-			if (method->type["return"] == "Nothing") {
-				output << "\treturn (obj_Nothing) (none);" << std::endl;
-			}
-			output << "}" << indent;
+	// time to print method definitions!
+	// ... the rest of the methods, at least
+	output << "// " << name << "'s other method definitions" << '\n';
+	for (auto method : currentClass->methods) {
+		output << functionCode[method];
+	}
+}
+
+void CodeGenerator::generateMethod(CodeBuffer &output, Qmethod *method) {
+	std::string name = method->clazz->name;
+	std::string returnType = method->type["return"];
+	std::string methodName = method->name;
+
+	FunctionContext fn(name + "_method_" + methodName);
+	output << profileAttribute(fn) << "obj_" << returnType << " " << name << "_method_" << methodName << "(";
+	int i = 0;
+
+	if (method->argtype.size() == 1) {
+		output << "obj_" << name << " this";
+	} else {
+		output << "obj_" << name << " this, ";
+	}
+	for (auto arg : method->argtype) {
+		if (arg.first == "Nothing" || arg.first == "return") {
+			output << "";
+			continue;
 		}
+		if (i == 0) {
+			output << "obj_" << arg.second << " " << arg.first;
+			++i;
+		} else {
+			output << ", obj_" << arg.second << " " << arg.first;
+		}
+	}
+	output << ")" << " {" << profileCounter("call " + fn.name) << '\n';
+	output.indent();
+	for (auto inited : method->type) {
+		if (inited.first == "return") {
+			continue;
+		}
+		if (std::find(method->args.begin(), method->args.end(), inited.first) != method->args.end()) {
+			continue;
+		}
+		output << "obj_" << inited.second << " " << inited.first << ";" << '\n';
+	}
+	for (AST::Node *stmt : method->stmts) {
+		generateStatement(output, fn, stmt, method, name);
 	}
-	output << "// -~-~-~-~- Methods End -~-~-~-~-" << indent;
+	if (method->type["return"] == "Nothing") {
+		output << "return (obj_Nothing) (none);" << '\n';
+	}
+	output.dedent();
+	output << "}" << blankLine;
 }
 
-void CodeGenerator::generateSingletons(std::ostream &output) {
-	output << "// -~-~-~-~- Singletons Begin -~-~-~-~-" << indent;
+void CodeGenerator::generateSingletons(CodeBuffer &output) {
+	output << "// -~-~-~-~- Singletons Begin -~-~-~-~-" << blankLine;
 	for (auto qclass : this->classes) {
 		auto currentClass = qclass.second;
-		std::string name = currentClass->name;
-		Qmethod *constructor = currentClass->constructor;
-		if (checkPrimitive(name)) {
+		if (checkPrimitive(currentClass->name)) {
 			continue;
-		} 
-		// printing out the singleton class 
-		output << "// The " << name << " class (singleton version)" << std::endl;
-		output << "struct class_" << name << "_struct the_class_" << name << "_struct = {" << std::endl;
-		output << "\t(class_Obj) &the_class_" << currentClass->super << "_struct," << std::endl;
-
-		// print the singleton's constructor
-		output << "\tnew_" << name << ", // constructor" << std::endl;
-
-		std::vector<std::string> alreadyPrinted;
-		// print the rest of the singleton's methods
-		for (auto method : this->methodGenerationOrder[name]) {
-			if (checkPrimitive(currentClass->super)) {
-				for (auto superMethod : this->classes[currentClass->super]->methods) {
-					if (superMethod->name == method->name) {
-						if (std::find(classInherited[name].begin(), classInherited[name].end(), method->name) != classInherited[name].end()) {
-							output << "\t" << currentClass->super << "_method_" << method->name << ",";
-							output << " // inherited from " << currentClass->super << std::endl;
-							alreadyPrinted.push_back(method->name);
-							this->classNameByMethod[method->name] = currentClass->super;
-						}
-					} else {
-						if (std::find(classInherited[name].begin(), classInherited[name].end(), method->name) != classInherited[name].end()) {
-							output << "";
-						} else if (std::find(alreadyPrinted.begin(), alreadyPrinted.end(), method->name) == alreadyPrinted.end()) {
-							output << "\t" << name << "_method_" << method->name << "," << std::endl;
-							alreadyPrinted.push_back(method->name);
-						}
-					}
-				}
-			} else {
-				for (auto superMethod : this->classes[currentClass->super]->methods) {
-					if (superMethod->name == method->name) {
-						if (std::find(classInherited[name].begin(), classInherited[name].end(), method->name) != classInherited[name].end()) {
-							output << "\t" << this->classNameByMethod[method->name] << "_method_" << method->name << ",";
-							output << " // inherited from " << this->classNameByMethod[method->name] << std::endl;
-							alreadyPrinted.push_back(method->name);
-						}
-					} else {
-						if (std::find(classInherited[name].begin(), classInherited[name].end(), method->name) != classInherited[name].end()) {
-							output << "";
-						} else if (std::find(alreadyPrinted.begin(), alreadyPrinted.end(), method->name) == alreadyPrinted.end()) {
-							output << "\t" << name << "_method_" << method->name << "," << std::endl;
-							alreadyPrinted.push_back(method->name);
-						}
-					}
-				}
-			}
 		}
-		output << "};" << indent;
+		generateSingleton(output, currentClass);
+	}
+	output << blankLine;
+	output << "// -~-~-~-~- Singletons End -~-~-~-~-" << blankLine;
+}
 
-		output << "class_" << name << " the_class_" << name << " = " << "&the_class_" << name << "_struct;" << std::endl;
+void CodeGenerator::generateSingleton(CodeBuffer &output, Qclass *currentClass) {
+	std::string name = currentClass->name;
+
+	// printing out the singleton class 
+	output << "// The " << name << " class (singleton version)" << '\n';
+	output << "struct class_" << name << "_struct the_class_" << name << "_struct = {" << '\n';
+	output.indent();
+	output << "(class_Obj) &the_class_" << currentClass->super << "_struct," << '\n';
+
+	// print the singleton's constructor
+	output << "new_" << name << ", // constructor" << '\n';
+
+	// print the rest of the singleton's methods, each from the class that defined it
+	for (Qmethod *method : currentClass->vtable) {
+		if (method->clazz != currentClass) {
+			output << method->clazz->name << "_method_" << method->name << ",";
+			output << " // inherited from " << method->clazz->name << '\n';
+		} else {
+			output << name << "_method_" << method->name << "," << '\n';
+		}
 	}
-	output << indent;
-	output << "// -~-~-~-~- Singletons End -~-~-~-~-" << indent;
+	output.dedent();
+	output << "};" << blankLine;
+
+	output << "class_" << name << " the_class_" << name << " = " << "&the_class_" << name << "_struct;" << '\n';
 }
 
-bool CodeGenerator::generateMain(std::ostream &output) {
-	output << "// -~-~-~-~- Main Method - it's the end! -~-~-~-~-" << std::endl;
+bool CodeGenerator::generateMain(CodeBuffer &output) {
+	output << "// -~-~-~-~- Main Method - it's the end! -~-~-~-~-" << '\n';
 
-	output << "int main(int argc, char *argv[]) {" << std::endl;
+	FunctionContext fn("main");
+	output << "int main(int argc, char *argv[]) {" << '\n';
+	output.indent();
 
 	Qclass *mainClass = this->tc->main;
 
@@ -521,127 +748,128 @@ bool CodeGenerator::generateMain(std::ostream &output) {
 				if (std::find(mainConstruct->args.begin(), mainConstruct->args.end(), inited.first) != mainConstruct->args.end()) {
 					continue;
 				}
-				output << "\tobj_" << inited.second << " " << inited.first << ";" << std::endl;
+				output << "obj_" << inited.second << " " << inited.first << ";" << '\n';
 		}
 
 		if (!mainStatements.empty()) {
 			for (AST::Node *stmt : mainStatements) {
-				generateStatement(output, stmt, mainClass->constructor);
+				generateStatement(output, fn, stmt, mainClass->constructor);
 			}
 		}
 	}
 
-	output << "\n\treturn 0;\n}" << std::endl;
+	output << '\n' << "return 0;" << '\n';
+	output.dedent();
+	output << "}" << '\n';
 
 	return true;
 }
 
-std::string CodeGenerator::generateStatement(std::ostream &output, AST::Node *stmt, Qmethod *whichMethod, std::string whichClass) {
+std::string CodeGenerator::generateStatement(CodeBuffer &output, FunctionContext &fn, AST::Node *stmt, Qmethod *whichMethod, std::string whichClass) {
 	Type nodeType = stmt->type;
-	//std::cerr << "the nodeType is : " << typeString(nodeType) << std::endl;
+	//std::cerr << "the nodeType is : " << typeString(nodeType) << '\n';
 	std::string name = whichClass;
-	Qclass *currentClass;
-	if (whichClass != "main") {
-		Qclass *currentClass = classes[whichClass];
-		name = currentClass->name;
-	}
 
 	if (nodeType == TYPECASE) {
 		AST::Node *var = stmt->get(LOAD);
-		std::string typeSwitch = generateStatement(output, var, whichMethod, name);
-		bool z = false;
-		std::string switchType = this->tc->typeInferStmt(whichMethod, var, z, z);
+		std::string typeSwitch = generateStatement(output, fn, var, whichMethod, name);
+		std::string switchType = staticType(var);
 		
 		std::string tempClass = "(class_" + switchType + ") " + typeSwitch + "->clazz";
 
-		std::string temp = "tempClass" + std::to_string(this->tempno);
-		output << "\tclass_" << switchType << " " << temp << " = " << tempClass << ";" << std::endl;
+		std::string temp = "tempClass" + std::to_string(fn.tempno);
+		output << "class_" << switchType << " " << temp << " = " << tempClass << ";" << '\n';
 
 		AST::Node *type_alts_container = stmt->get(TYPE_ALTERNATIVES);
-		std::vector<AST::Node *> type_alts = type_alts_container->getAll(TYPE_ALTERNATIVE);
+		AST::ChildRange type_alts = type_alts_container->getAll(TYPE_ALTERNATIVE);
 
-		output << "\twhile (" << temp << ") {" << std::endl;
+		output << "while (" << temp << ") {" << '\n';
 
 		for (AST::Node *type_alt : type_alts) {
 			AST::Node *ident = type_alt->getBySubtype(VAR_IDENT);
 			AST::Node *ident_type = type_alt->getBySubtype(TYPE_IDENT);
 			AST::Node *type_stmts = type_alt->get(BLOCK, STATEMENTS);
-			output << "\tif (" << temp << " == (class_" << switchType << ") the_class_" << ident_type->name << ") {" << std::endl;
-			output << "\t" << ident->name << " = " << "(obj_" << ident_type->name << ") " << typeSwitch << ";" << std::endl;
+			output << "if (" << temp << " == (class_" << switchType << ") the_class_" << ident_type->name() << ") {" << '\n';
+			output << ident->name() << " = " << "(obj_" << ident_type->name() << ") " << typeSwitch << ";" << '\n';
 			for (AST::Node *type_stmt : type_stmts->rawChildren) {
-				generateStatement(output, type_stmt, whichMethod, name);
+				generateStatement(output, fn, type_stmt, whichMethod, name);
 			}
-			output << "\tbreak;" << std::endl << "\t}" << std::endl;
+			output << "break;" << '\n' << "}" << '\n';
 		}
-		output << "\telse {" << std::endl << "\t" << temp << " = " << temp << "->super;" << std::endl << "\t}" << std::endl;
-		output << "\t}" << std::endl;
+		output << "else {" << '\n' << temp << " = " << temp << "->super;" << '\n' << "}" << '\n';
+		output << "}" << '\n';
 		return "";
 	}
 
 	if (nodeType == WHILE) {
 		AST::Node *cond = stmt->get(COND)->rawChildren[0];
 
-		std::string testcondString = "test_cond" + std::to_string(this->tempno);
-		std::string loopagainString = "loop_again" + std::to_string(this->tempno);
-		std::string endwhileString = "end_while" + std::to_string(this->tempno);
-		std::string halfwayString = "halfway" + std::to_string(this->tempno);
+		std::string testcondString = "test_cond" + std::to_string(fn.tempno);
+		std::string loopagainString = "loop_again" + std::to_string(fn.tempno);
+		std::string endwhileString = "end_while" + std::to_string(fn.tempno);
+		std::string halfwayString = "halfway" + std::to_string(fn.tempno);
 
-		output << "\tgoto " << testcondString << ";" << std::endl;
-		output << "\t" << loopagainString << ": ; // Null statement" << std::endl; 
+		output << "goto " << testcondString << ";" << '\n';
+		output << loopagainString << ": ; // Null statement" << '\n'; 
 
-		++this->tempno;
+		++fn.tempno;
 		AST::Node *while_stmts = stmt->get(BLOCK, STATEMENTS);
 		for (AST::Node *while_stmt : while_stmts->rawChildren) {
-			generateStatement(output, while_stmt, whichMethod, name);
+			generateStatement(output, fn, while_stmt, whichMethod, name);
 		}
 
-		output << "\t" << testcondString << ": ; // Null statement" << std::endl;
-		output << "\tgoto " << halfwayString << ";" << std::endl;
-		output << "\t" << halfwayString << ": ; // Null statement" << std::endl;
+		output << testcondString << ": ; // Null statement" << '\n';
+		output << "goto " << halfwayString << ";" << '\n';
+		output << halfwayString << ": ; // Null statement" << '\n';
 
 		if (cond != NULL) {
-			std::string condStatement = generateStatement(output, cond, whichMethod, name);
-			output << "\tif (lit_true == " << condStatement << ") { goto " << loopagainString << "; }" << std::endl;
-			output << "\tgoto " << endwhileString << ";" << std::endl;
+			std::string condStatement = generateStatement(output, fn, cond, whichMethod, name);
+			std::string site = fn.name + "." + std::to_string(fn.branchno++);
+			output << "if (" << profileBranch("lit_true == " + condStatement, site) << ") {" << profileCounter("taken " + site);
+			output << " goto " << loopagainString << "; }" << '\n';
+			output << profileCounter("nottaken " + site, true) << "goto " << endwhileString << ";" << '\n';
 		}
-		output << "\t" << endwhileString << ": ; // Null statement" << std::endl;
+		output << endwhileString << ": ; // Null statement" << '\n';
 
 		return "";
 	}
 
 	if (nodeType == IF) {
 		AST::Node *cond = stmt->get(COND)->rawChildren[0];
+		std::string site;
 		if (cond != NULL) {
-			std::string condName = generateStatement(output, cond, whichMethod, name);
-			output << "\tif (lit_true == " << condName << ") { goto if" << this->tempno << "; }" << std::endl;
+			std::string condName = generateStatement(output, fn, cond, whichMethod, name);
+			site = fn.name + "." + std::to_string(fn.branchno++);
+			output << "if (" << profileBranch("lit_true == " + condName, site) << ") {" << profileCounter("taken " + site);
+			output << " goto if" << fn.tempno << "; }" << '\n';
 		}
-		std::string ifString = "if" + std::to_string(this->tempno);
-		std::string elseString = "else" + std::to_string(this->tempno);
-		std::string endifString = "endif" + std::to_string(this->tempno);
+		std::string ifString = "if" + std::to_string(fn.tempno);
+		std::string elseString = "else" + std::to_string(fn.tempno);
+		std::string endifString = "endif" + std::to_string(fn.tempno);
 
-		output << "\tgoto " << elseString << ";" << std::endl;
-		output << "\t// if statement true part!" << std::endl;
+		output << (site.empty() ? "" : profileCounter("nottaken " + site, true)) << "goto " << elseString << ";" << '\n';
+		output << "// if statement true part!" << '\n';
 
-		output << "\t" << ifString << ": ; // Null statement" << std::endl;
+		output << ifString << ": ; // Null statement" << '\n';
 
-		++this->tempno;
+		++fn.tempno;
 		AST::Node *true_stmts = stmt->get(BLOCK, TRUE_STATEMENTS);
 		for (AST::Node *true_stmt : true_stmts->rawChildren) {
-			std::string generatedTrue = generateStatement(output, true_stmt, whichMethod, name);
+			std::string generatedTrue = generateStatement(output, fn, true_stmt, whichMethod, name);
 		}
-		output << "\tgoto " << endifString << ";" << std::endl;
+		output << "goto " << endifString << ";" << '\n';
 	
-		output << "\t// if statement false part!" << std::endl;
+		output << "// if statement false part!" << '\n';
 
-		output << "\t" << elseString << ": ; // Null statement" << std::endl;
+		output << elseString << ": ; // Null statement" << '\n';
 
 		AST::Node *false_stmts = stmt->get(BLOCK, FALSE_STATEMENTS);
 		for (AST::Node *false_stmt : false_stmts->rawChildren) {
-			std::string generatedFalse = generateStatement(output, false_stmt, whichMethod, name);
+			std::string generatedFalse = generateStatement(output, fn, false_stmt, whichMethod, name);
 		}
-		output << "\tgoto " << endifString << ";" << std::endl;
+		output << "goto " << endifString << ";" << '\n';
 
-		output << "\t" << endifString << ": ; // Null statement" << std::endl;
+		output << endifString << ": ; // Null statement" << '\n';
 
 		return "";
 	}
@@ -650,29 +878,29 @@ std::string CodeGenerator::generateStatement(std::ostream &output, AST::Node *st
 		AST::Node *class_name_node = stmt->get(IDENT);
 		std::string retVal;
 		if (class_name_node != NULL) {
-			std::string class_name = class_name_node->name;
+			std::string class_name = class_name_node->name();
 			retVal =  "new_" + class_name + "(";
-			Qclass *qclass = this->classes[class_name];
+			Qclass *qclass = this->tc->findClass(class_name);
 			Qmethod *constructorMethod = qclass->constructor;
 			int numArgsConstructor = constructorMethod->args.size();
 
 			// make sure all our args line up
 			AST::Node *actual_args_container = stmt->get(ACTUAL_ARGS);
 			if (actual_args_container != NULL) {
-				std::vector<AST::Node *> actual_args = actual_args_container->getAll(METHOD_ARG);
+				AST::ChildRange actual_args = actual_args_container->getAll(METHOD_ARG);
 				if (!actual_args.empty()) {
 					std::vector<std::string> argNames;
 					std::vector<std::string> argTypes;
 					for (AST::Node *arg : actual_args) {
 						AST::Node *subLexpr = arg->getBySubtype(METHOD_ARG);
-						std::string argName = generateStatement(output, subLexpr, whichMethod, name);
+						std::string argName = generateStatement(output, fn, subLexpr, whichMethod, name);
 						argNames.push_back(argName);
 					}
 
 					int numArgsCallToConstructor = argNames.size();
 					for (int i = 0; i < numArgsConstructor; i++) {
 						std::string constructorArg = constructorMethod->args[i]; // get arg name from class we are constructing
-						std::string constructorArgType = constructorMethod->argtype[constructorArg]; // get the type of that arg
+						std::string constructorArgType = constructorMethod->argtype.at(constructorArg); // get the type of that arg
 						argTypes.push_back(constructorArgType);
 						std::string callToConstructorType = argNames[i]; // type of arg i in our call to the constructor
 					}
@@ -694,9 +922,9 @@ std::string CodeGenerator::generateStatement(std::ostream &output, AST::Node *st
 						retVal += ")";
 					}
 				}
-				output << "\tobj_" << class_name << " tempVar" << this->tempno << " = " << retVal << ";" << std::endl;
-				std::string returned = "tempVar" + std::to_string(this->tempno);
-				++this->tempno;
+				output << "obj_" << class_name << " tempVar" << fn.tempno << " = " << retVal << ";" << '\n';
+				std::string returned = "tempVar" + std::to_string(fn.tempno);
+				++fn.tempno;
 				return returned;
 			}
 		}
@@ -705,134 +933,142 @@ std::string CodeGenerator::generateStatement(std::ostream &output, AST::Node *st
 	if (nodeType == CALL) { // a call always has 3 children
 		// if (stmt->skip) return lhsType; // we dont want to error check again
 		AST::Node *lhs = stmt->rawChildren[0]; // left hand side can be any type of node
-		std::string lhsStmt = generateStatement(output, lhs, whichMethod, name);
-		bool z = false;
-		std::string returnType = this->tc->typeInferStmt(whichMethod, stmt, z, z);
-		std::string lhsType = this->tc->typeInferStmt(whichMethod, lhs, z, z);
-		std::string methodName = stmt->rawChildren[1]->name; // center node is always the ident corresponding to method name
-
-		Qclass *qclass;
-		Qclass *qclass_temp;
-		Qmethod *calledMethod;
-
-		bool foundMethod = false;
-		qclass = this->classes[lhsType];
-		qclass_temp = qclass;
-		find: // keep jumping to this label if we haven't seen the method yet
-			//OUT << "current class we're iterating over is " << qclass_temp->name << END;
-			for (Qmethod *m : qclass_temp->methods) {
-				//OUT << "	mname is " << m->name << END;
-				if (m->name == methodName) {
-					foundMethod = true;
-					calledMethod = m;
-					break;
-				}
-			}
+		std::string lhsStmt = generateStatement(output, fn, lhs, whichMethod, name);
+		std::string returnType = staticType(stmt);
+		std::string lhsType = staticType(lhs);
+		std::string methodName = stmt->rawChildren[1]->name(); // center node is always the ident corresponding to method name
+		Symbol methodId = stmt->rawChildren[1]->symbol;
 
-		if (!foundMethod) { // if we haven't seen the method yet, iterate through the supers
-			if (qclass_temp->name != "Obj") { // we're at the top of the tree, stop looking
-				qclass_temp = this->classes[qclass_temp->super];
-				goto find;
-			}
-		}
+		Qmethod *calledMethod = this->tc->resolveMethod(this->tc->findClass(lhs->staticType), methodId);
 
 		if (methodName == "NOT") {
-				output << "\tobj_Boolean tempBool" << this->tempno << " = !" << lhsStmt << ";" << std::endl;
-				std::string retVal = "tempBool" + std::to_string(this->tempno);
-				++this->tempno;
+				// the operand is a Boolean object, so "!" on it would only test the pointer
+				output << "obj_Boolean tempBool" << fn.tempno << " = (" << lhsStmt << " == lit_true) ? lit_false : lit_true;" << '\n';
+				std::string retVal = "tempBool" + std::to_string(fn.tempno);
+				++fn.tempno;
 				return retVal;
 		}
 		if (methodName == "AND" || methodName == "OR") {
 			AST::Node *actual_args_container = stmt->get(ACTUAL_ARGS);
 			if (actual_args_container != NULL) {
-				std::vector<AST::Node *> actual_args = actual_args_container->getAll(METHOD_ARG);
+				AST::ChildRange actual_args = actual_args_container->getAll(METHOD_ARG);
 				if (actual_args.size() == 1) {
 					AST::Node *real_arg = actual_args.front()->getBySubtype(METHOD_ARG);
+					// the result is numbered by labelno, like the labels around it. it
+					// gets a name of its own so it can't clash with a tempno temp
 					if (methodName == "AND") {
 						// begin and
-						output << "\t// and statement beginning!" << std::endl;
+						output << "// and statement beginning!" << '\n';
 
 						// returned boolean
-						output << "\tobj_Boolean tempBool" << this->labelno << " = lit_false;" << std::endl;
+						output << "obj_Boolean tempAndOr" << fn.labelno << " = lit_false;" << '\n';
 
 						// first side
-						output << "\tif (lit_true == " << lhsStmt << ") { goto and_HALFWAY" << this->labelno << "; }" << std::endl;
-						output << "\tgoto and_END" << this->labelno << ";" << std::endl;
-						output << "\tand_HALFWAY" << this->labelno << ": ; // Null statement" << std::endl;
+						output << "if (lit_true == " << lhsStmt << ") { goto and_HALFWAY" << fn.labelno << "; }" << '\n';
+						output << "goto and_END" << fn.labelno << ";" << '\n';
+						output << "and_HALFWAY" << fn.labelno << ": ; // Null statement" << '\n';
 						
 						// second side
-						std::string argStmt = generateStatement(output, real_arg, whichMethod, name);
-						output << "\tif (lit_true == " << argStmt << ") { goto and_TRUE" << this->labelno << "; }" << std::endl;
-						output << "\tgoto and_END" << this->labelno << ";" << std::endl;
+						std::string argStmt = generateStatement(output, fn, real_arg, whichMethod, name);
+						output << "if (lit_true == " << argStmt << ") { goto and_TRUE" << fn.labelno << "; }" << '\n';
+						output << "goto and_END" << fn.labelno << ";" << '\n';
 
 						// get the true version
-						output << "\tand_TRUE" << this->labelno << ": ; // Null statement" << std::endl;
-						output << "\ttempBool" << this->labelno << " = lit_true;" << std::endl;
+						output << "and_TRUE" << fn.labelno << ": ; // Null statement" << '\n';
+						output << "tempAndOr" << fn.labelno << " = lit_true;" << '\n';
 						// the end, wasn't true
-						output << "\tand_END" << this->labelno << ": ; // Null statement" << std::endl;
+						output << "and_END" << fn.labelno << ": ; // Null statement" << '\n';
 
 						// end and
-						output << "\t// and statement done!" << std::endl;
+						output << "// and statement done!" << '\n';
 
-						std::string retVal = "tempBool" + std::to_string(this->labelno);
-						++this->labelno;
+						std::string retVal = "tempAndOr" + std::to_string(fn.labelno);
+						++fn.labelno;
 						return retVal;
 					} else {
 						// begin or
-						output << "\t// or statement beginning!" << std::endl;
+						output << "// or statement beginning!" << '\n';
 
 						// returned boolean
-						output << "\tobj_Boolean tempBool" << this->labelno << " = lit_false;" << std::endl;
+						output << "obj_Boolean tempAndOr" << fn.labelno << " = lit_false;" << '\n';
 
 						// first side
-						output << "\tif (lit_true == " << lhsStmt << ") { goto or_TRUE" << this->labelno << "; }" << std::endl;
-						output << "\tgoto or_END" << this->labelno << ";" << std::endl;
-						output << "\tor_HALFWAY" << this->labelno << ": ; // Null statement" << std::endl;
+						output << "if (lit_true == " << lhsStmt << ") { goto or_TRUE" << fn.labelno << "; }" << '\n';
+						// false so far, so it's up to the second side
+						output << "goto or_HALFWAY" << fn.labelno << ";" << '\n';
+						output << "or_HALFWAY" << fn.labelno << ": ; // Null statement" << '\n';
 						
 						// second side
-						std::string argStmt = generateStatement(output, real_arg, whichMethod, name);
-						output << "\tif (lit_true == " << argStmt << ") { goto or_TRUE" << this->labelno << "; }" << std::endl;
-						output << "\tgoto or_END" << this->labelno << ";" << std::endl;
+						std::string argStmt = generateStatement(output, fn, real_arg, whichMethod, name);
+						output << "if (lit_true == " << argStmt << ") { goto or_TRUE" << fn.labelno << "; }" << '\n';
+						output << "goto or_END" << fn.labelno << ";" << '\n';
 
 						// get the true version
-						output << "\tor_TRUE" << this->labelno << ": ; // Null statement" << std::endl;
-						output << "\ttempBool" << this->labelno << " = lit_true;" << std::endl;
+						output << "or_TRUE" << fn.labelno << ": ; // Null statement" << '\n';
+						output << "tempAndOr" << fn.labelno << " = lit_true;" << '\n';
 						// the end, wasn't true
-						output << "\tor_END" << this->labelno << ": ; // Null statement" << std::endl;
+						output << "or_END" << fn.labelno << ": ; // Null statement" << '\n';
 
 						// end and
-						output << "\t// and statement done!" << std::endl;
+						output << "// and statement done!" << '\n';
 
-						std::string retVal = "tempBool" + std::to_string(this->labelno);
-						++this->labelno;
+						std::string retVal = "tempAndOr" + std::to_string(fn.labelno);
+						++fn.labelno;
 						return retVal;
 					}
 				}
 			}
 		}
 
-		// std::cerr << whichMethod->argtype["other"] << std::endl;
+		// std::cerr << whichMethod->argtype["other"] << '\n';
 		std::vector<std::string> argNames;
+		std::vector<std::string> argTypes;
 
 		// make sure all our args line up
 		AST::Node *actual_args_container = stmt->get(ACTUAL_ARGS);
 		if (actual_args_container != NULL) {
-			std::vector<AST::Node *> actual_args = actual_args_container->getAll(METHOD_ARG);
+			AST::ChildRange actual_args = actual_args_container->getAll(METHOD_ARG);
 			if (!actual_args.empty()) {
 				for (AST::Node *arg : actual_args) {
 					AST::Node *real_arg = arg->getBySubtype(METHOD_ARG); // the actual arg node is inside of the "METHOD_ARG" node
-					std::string argName = generateStatement(output, real_arg, whichMethod, name);
+					std::string argName = generateStatement(output, fn, real_arg, whichMethod, name);
 					argNames.push_back(argName);
+					argTypes.push_back(staticType(real_arg));
 				}
 			} 
 		}
 
 		std::string retVal;
 
-		output << "\tobj_" << returnType << " tempResult" << this->tempno << " = " << lhsStmt <<
-		"->clazz->" << methodName << "(";
-		retVal = "tempResult" + std::to_string(this->tempno);
-		++this->tempno;
+		// Int arithmetic and comparisons between two Ints are done on the unboxed
+		// values right here, instead of calling into the runtime
+		std::string intOp = intOperator(methodName);
+		if (lhsType == "Int" && argTypes.size() == 1 && argTypes[0] == "Int" && intOp != "") {
+			std::string lhsValue = "((obj_Int) " + lhsStmt + ")->value";
+			std::string argValue = "((obj_Int) " + argNames[0] + ")->value";
+			if (returnType == "Int") {
+				output << "obj_Int tempResult" << fn.tempno << " = int_literal(" <<
+				lhsValue << " " << intOp << " " << argValue << ");" << '\n';
+			} else {
+				output << "obj_Boolean tempResult" << fn.tempno << " = (" <<
+				lhsValue << " " << intOp << " " << argValue << ") ? lit_true : lit_false;" << '\n';
+			}
+			retVal = "tempResult" + std::to_string(fn.tempno);
+			++fn.tempno;
+			return retVal;
+		}
+
+		// the built-in final classes always resolve to the same method, so we can
+		// call it directly instead of going through the method table
+		if (checkFinal(lhsType)) {
+			output << "obj_" << returnType << " tempResult" << fn.tempno << " = " <<
+			calledMethod->clazz->name << "_method_" << methodName << "(";
+		} else {
+			output << "obj_" << returnType << " tempResult" << fn.tempno << " = " << lhsStmt <<
+			"->clazz->" << methodName << "(";
+		}
+		retVal = "tempResult" + std::to_string(fn.tempno);
+		++fn.tempno;
 
 
 		int i = 0;
@@ -843,15 +1079,15 @@ std::string CodeGenerator::generateStatement(std::ostream &output, AST::Node *st
 		}
 		for (auto arg : argNames) {
 			if (i == 0) {
-				output << "(obj_" << calledMethod->argtype[calledMethod->args[i]] << ") " << arg;
+				output << "(obj_" << calledMethod->argtype.at(calledMethod->args[i]) << ") " << arg;
 				++i;
 			} else {
-				output << ", (obj_" << calledMethod->argtype[calledMethod->args[i]] << ") " << arg;
+				output << ", (obj_" << calledMethod->argtype.at(calledMethod->args[i]) << ") " << arg;
 				++i;
 			}
 		}
 
-		output << ");" << std::endl;
+		output << ");" << '\n';
 		return retVal;
 	}
 
@@ -860,13 +1096,13 @@ std::string CodeGenerator::generateStatement(std::ostream &output, AST::Node *st
 		// assign of form "this.x = ..."
 		AST::Node *left = stmt->get(DOT, L_EXPR);
 		if (left != NULL) {
-			std::string rhs = generateStatement(output, r_expr, whichMethod, name);
+			std::string rhs = generateStatement(output, fn, r_expr, whichMethod, name);
 			AST::Node *load = left->get(LOAD);
 			if (load != NULL) {
-				if (load->get(IDENT)->name == "this") { // we have found a this.x = ... statement
-					std::string instanceVar = left->get(IDENT)->name;
+				if (load->get(IDENT)->name() == "this") { // we have found a this.x = ... statement
+					std::string instanceVar = left->get(IDENT)->name();
 
-					output << "\tthis->" << instanceVar << " = " << rhs << ";" << std::endl;
+					output << "this->" << instanceVar << " = " << rhs << ";" << '\n';
 
 					return "";
 				}
@@ -876,13 +1112,13 @@ std::string CodeGenerator::generateStatement(std::ostream &output, AST::Node *st
 		// assign of form "x = ..." and "x : Clss = ..."
 		left = stmt->get(IDENT, LOC);
 		if (left != NULL) {
-			std::string rhs = generateStatement(output, r_expr, whichMethod, name);
+			std::string rhs = generateStatement(output, fn, r_expr, whichMethod, name);
 
-			std::string castType = whichMethod->type[left->name];
+			std::string castType = whichMethod->type[left->name()];
 
-			output << "\t" << left->name << " = ";
+			output << left->name() << " = ";
 
-			output << "(obj_" << castType << ") (" << rhs << ");" << std::endl;
+			output << "(obj_" << castType << ") (" << rhs << ");" << '\n';
 
 			return "";
 		}
@@ -892,19 +1128,19 @@ std::string CodeGenerator::generateStatement(std::ostream &output, AST::Node *st
 		AST::Node *load = stmt->get(LOAD);
 		if (load != NULL) {
 			// we have a "this.x" somewhere in a method, make appropriate checks
-			std::string lhs = generateStatement(output, stmt->rawChildren[0], whichMethod, name);
+			std::string lhs = generateStatement(output, fn, stmt->rawChildren[0], whichMethod, name);
 			if (lhs == "this") {
-				std::string instanceVar = stmt->get(IDENT)->name;
+				std::string instanceVar = stmt->get(IDENT)->name();
 				std::string completeDot = (lhs + "->" + instanceVar);
 				return completeDot;
 			} else { // we have an "x.y" somewhere in a method
-				std::string instanceVar = stmt->getBySubtype(R_EXPR)->name;
+				std::string instanceVar = stmt->getBySubtype(R_EXPR)->name();
 				std::string completeDot = (lhs + "->" + instanceVar);
 				return completeDot;
 			}
 		} else { // if the lhs of the DOT isn't a load, we have to infer its type generically
-			std::string lhsTemp = generateStatement(output, stmt->rawChildren[0], whichMethod, name);
-			std::string instanceVar = stmt->getBySubtype(R_EXPR)->name;
+			std::string lhsTemp = generateStatement(output, fn, stmt->rawChildren[0], whichMethod, name);
+			std::string instanceVar = stmt->getBySubtype(R_EXPR)->name();
 
 			std::string completeDot = (lhsTemp + "->" + instanceVar);
 			return completeDot;
@@ -914,23 +1150,23 @@ std::string CodeGenerator::generateStatement(std::ostream &output, AST::Node *st
 	if (nodeType == RETURN) {
 		AST::Node *load = stmt->getBySubtype(R_EXPR);
 		if (load != NULL) {
-			std::string returned = generateStatement(output, load, whichMethod, name);
+			std::string returned = generateStatement(output, fn, load, whichMethod, name);
 			for (auto tbd : whichMethod->type) {
 				if (tbd.first == "return") {
 					std::string returnedTypeCast = "(obj_" + tbd.second + ")";
-					output << "\treturn " << returnedTypeCast << " (" << returned << ");" << std::endl;
+					output << "return " << returnedTypeCast << " (" << returned << ");" << '\n';
 					return "";
 				}
 			}
 		} else {
-			output << "\treturn " << "(obj_Obj) none;" << std::endl;
+			output << "return " << "(obj_Obj) none;" << '\n';
 			return "";
 		}
 	}
 
 	if (nodeType == LOAD) {
 		if (stmt->get(IDENT) != NULL) { 
-			std::string ident = stmt->get(IDENT)->name;
+			std::string ident = stmt->get(IDENT)->name();
 			if (ident == "this") {
 				return "this";
 			} else if (ident == "true" || ident == "false") { 
@@ -941,29 +1177,29 @@ std::string CodeGenerator::generateStatement(std::ostream &output, AST::Node *st
 			}
 		} else {
 			// if it doesn't go straight to an ident, grab whatever it's loading (most likely a dot)
-			return generateStatement(output, stmt->rawChildren[0], whichMethod, name);
+			return generateStatement(output, fn, stmt->rawChildren[0], whichMethod, name);
 		}
 	}
 
 	if (nodeType == INTCONST) {
-		output << "\tobj_Int tempInt" << this->tempno <<  " = int_literal(" << stmt->value << ");" << std::endl;
-		++this->tempno;
-		return ("tempInt" + std::to_string(this->tempno - 1));
+		output << "obj_Int tempInt" << fn.tempno <<  " = int_literal(" << stmt->value << ");" << '\n';
+		++fn.tempno;
+		return ("tempInt" + std::to_string(fn.tempno - 1));
 	}
 
 	if (nodeType == STRCONST) {
-		output << "\tobj_String tempStr" << this->tempno <<  " = str_literal(\"" << stmt->name << "\");" << std::endl;
-		++this->tempno;
-		return ("tempStr" + std::to_string(this->tempno - 1));
+		output << "obj_String tempStr" << fn.tempno <<  " = str_literal(\"" << stmt->name() << "\");" << '\n';
+		++fn.tempno;
+		return ("tempStr" + std::to_string(fn.tempno - 1));
 	}
 
 	if (nodeType == IDENT) {
-		if (stmt->name == "true" || stmt->name == "false") {
-			output << "\tobj_Boolean tempBool" << this->tempno <<  " = " << "lit_" << stmt->name << "_struct" << std::endl;
-			++this->tempno;
-			return ("tempBool" + std::to_string(this->tempno - 1));
+		if (stmt->name() == "true" || stmt->name() == "false") {
+			output << "obj_Boolean tempBool" << fn.tempno <<  " = " << "lit_" << stmt->name() << "_struct" << '\n';
+			++fn.tempno;
+			return ("tempBool" + std::to_string(fn.tempno - 1));
 		} else {
-			std::cerr << "got to ident that isn't a bool?" << std::endl;
+			report::err() << "got to ident that isn't a bool?" << '\n';
 		}
 	}
 }
\ No newline at end of file
@@ -5,8 +5,22 @@
 #include "ASTNode.h"
 #include "Messages.h"
 #include "typechecker.h"
+#include "codebuffer.h"
 #include <list>
 
+// Everything that belongs to the one C function being generated: its name (for
+// finding its calls and branches in a profile), and its counters for temps, labels
+// and branches. Temps and labels are local to a C function, so every function
+// numbers its own from zero and functions can be generated independently.
+struct FunctionContext {
+        std::string name;
+        int tempno = 0;
+        int labelno = 0;
+        int branchno = 0;
+
+        explicit FunctionContext(std::string name) : name(name) { };
+};
+
 class CodeGenerator {
 	public:
         /* ============ */
@@ -18,27 +32,35 @@ class CodeGenerator {
 		Typechecker *tc;
 		std::vector<std::string> primitives = {};
 		std::vector<std::string> printedClasses;
-		std::map<std::string, std::vector<Qmethod *>> methodGenerationOrder;
 		std::map<std::string, std::vector<std::string>> fieldGenerationOrder;
-		std::map<std::string, std::vector<std::string>> classInherited;
-		std::map<std::string, std::string> classNameByMethod;
 
-		// indent for codegen
-        std::string indent = "\n\n";
+		// ends a line and leaves a blank one, between sections of the output
+        std::string blankLine = "\n\n";
 
         // filename for outputting
         std::string filename;
 
-        // variable for counting temps, variable for printing arguments correctly
-        int labelno = 0;
-        int tempno = 0;
-        int i = 0;
+        // split output into a header and one file per class, and the .c files that were written
+        bool split = false;
+        std::vector<std::string> sourceFiles;
+
+        // profile-guided optimization: with profileGenerate the program counts its calls and
+        // branches into profilePath, with profileUse the counts from an earlier run are used
+        bool profileGenerate = false;
+        bool profileUse = false;
+        std::string profilePath;
+        std::vector<std::string> profileSites;
+        std::map<std::string, long long> profileCounts;
+        long long maxCalls = 0;
+
+        // the generated code for every constructor and method (see generateFunctions)
+        std::map<Qmethod*, CodeBuffer> functionCode;
 
         /* ========================== */
         /* Constructors & Destructors */
         /* ========================== */
 
-        CodeGenerator(Typechecker *tc, std::string fname) : classes(tc->classes), filename(fname), tc(tc) { };
+        CodeGenerator(Typechecker *tc, std::string fname, bool split=false) : classes(tc->classes), filename(fname), split(split), tc(tc) { };
         virtual ~CodeGenerator() { };
 
         /* ======= */
@@ -47,25 +69,42 @@ class CodeGenerator {
 
 		/* ==== main code generation methods ==== */
 		bool generate();
-        bool generateClasses(std::ostream &output);
-        bool generateMain(std::ostream &output);
+		bool generateSplit();
+		bool writeOut(CodeBuffer &buffer, std::string path);
+        bool generateClasses(CodeBuffer &output);
+        bool generateMain(CodeBuffer &output);
+        void generateFunctions();
 
         /* ==== helper functions for the main code generation ==== */
+        bool loadProfile(std::string path);
         bool checkPrimitive(std::string name);
-        void generateTypedefs(std::ostream &output);
+        bool checkFinal(std::string name);
+        std::string intOperator(std::string methodName);
+        std::string staticType(AST::Node *node);
+        void generateTypedefs(CodeBuffer &output);
         // helper functions for generateClasses
-        void generateForwardDecls(std::ostream &output);
-		void generateStructs(std::ostream &output);
-		void generateStruct(std::ostream &output, Qclass *whichClass); // helper function for generateStructs
-		void generateConstructor(std::ostream &output, Qclass *whichClass); // helper function for generateStructs
-		void methodOrderer(std::ostream &output, std::vector<Qmethod *> whereToLook, Qclass *currentClass);
-		void generateExterns(std::ostream &output);
-		void generateMethods(std::ostream &output);
-		void generateSingletons(std::ostream &output);
+        void generateForwardDecls(CodeBuffer &output);
+		void generateStructs(CodeBuffer &output);
+		void generateStruct(CodeBuffer &output, Qclass *whichClass); // helper function for generateStructs
+		void generateConstructor(CodeBuffer &output, Qclass *whichClass); // helper function for generateStructs
+		void generateMethodTable(CodeBuffer &output, Qclass *currentClass); // helper function for generateStruct
+		void generateExterns(CodeBuffer &output);
+		void generateMethods(CodeBuffer &output);
+		void generateClassMethods(CodeBuffer &output, Qclass *currentClass); // helper function for generateMethods
+		void generateMethod(CodeBuffer &output, Qmethod *method); // helper function for generateFunctions
+		void generateSingletons(CodeBuffer &output);
+		void generateSingleton(CodeBuffer &output, Qclass *currentClass); // helper function for generateSingletons
 		// helper functions for generateMain
-        void generateMainCall(std::ostream &output, AST::Node *stmt);
+        void generateMainCall(CodeBuffer &output, AST::Node *stmt);
+        // helper functions for profile-guided optimization
+        std::string profileCounter(std::string label, bool before=false);
+        std::string profileAttribute(const FunctionContext &fn);
+        long long profileCount(const std::string &site);
+        std::string profileBranch(std::string cond, std::string site);
+        void generateProfileDecl(CodeBuffer &output);
+        void generateProfileDump(CodeBuffer &output);
         // helper function for generating statements
-        std::string generateStatement(std::ostream &output, AST::Node *stmt, Qmethod *whichMethod, std::string whichClass="main");
+        std::string generateStatement(CodeBuffer &output, FunctionContext &fn, AST::Node *stmt, Qmethod *whichMethod, std::string whichClass="main");
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <map>
+#include <set>
+#include "dataflow.h"
+
+DataflowResult solveDataflow(const ControlFlowGraph &cfg, const DataflowProblem &problem) {
+	size_t count = cfg.blocks.size();
+	SlotSet start = problem.must ? SlotSet::all(problem.slots) : SlotSet();
+	DataflowResult result;
+	result.in.assign(count, start);
+	result.out.assign(count, start);
+
+	// a backward problem is a forward one on the graph turned around
+	std::vector<BasicBlock*> order = cfg.reversePostorder();
+	if (!problem.forward) std::reverse(order.begin(), order.end());
+	BasicBlock *boundary = problem.forward ? cfg.entry : cfg.exit;
+	std::vector<SlotSet> &before = problem.forward ? result.in : result.out;
+	std::vector<SlotSet> &after = problem.forward ? result.out : result.in;
+
+	// the worklist is of places in the order, so blocks come off it in that order
+	std::vector<size_t> position(count);
+	std::set<size_t> worklist;
+	for (size_t i = 0; i < order.size(); i++) {
+		position[order[i]->id] = i;
+		worklist.insert(i);
+	}
+
+	while (!worklist.empty()) {
+		BasicBlock *block = order[*worklist.begin()];
+		worklist.erase(worklist.begin());
+		const std::vector<BasicBlock*> &from = problem.forward ? block->preds : block->succs;
+		const std::vector<BasicBlock*> &to = problem.forward ? block->succs : block->preds;
+
+		// nothing reaching a must problem's block means anything goes there
+		SlotSet facts = start;
+		if (block == boundary) {
+			facts = problem.boundary;
+		} else {
+			for (BasicBlock *other : from) {
+				if (problem.must) facts &= after[other->id];
+				else facts |= after[other->id];
+			}
+		}
+		before[block->id] = facts;
+
+		facts.remove(problem.kill[block->id]);
+		facts |= problem.gen[block->id];
+		if (facts != after[block->id]) {
+			after[block->id] = facts;
+			for (BasicBlock *next : to) {
+				worklist.insert(position[next->id]);
+			}
+		}
+	}
+	return result;
+}
+
+Symbol assignedVariable(AST::Node *stmt) {
+	if (stmt->type == TYPE_ALTERNATIVE) {
+		return stmt->getBySubtype(VAR_IDENT)->symbol;
+	}
+	if (stmt->type != ASSIGN) return NO_SYMBOL;
+
+	// assigning to these is an error, not a variable
+	AST::Node *left = stmt->get(IDENT, LOC);
+	if (left == NULL || left->symbol == SYM_THIS || left->symbol == SYM_TRUE || left->symbol == SYM_FALSE) {
+		return NO_SYMBOL;
+	}
+	return left->symbol;
+}
+
+Symbol assignedField(AST::Node *stmt) {
+	if (stmt->type != ASSIGN) return NO_SYMBOL;
+	AST::Node *left = stmt->get(DOT, L_EXPR);
+	if (left == NULL) return NO_SYMBOL;
+	AST::Node *load = left->get(LOAD);
+	if (load == NULL || load->get(IDENT) == NULL || load->get(IDENT)->symbol != SYM_THIS) return NO_SYMBOL;
+	return left->get(IDENT)->symbol;
+}
+
+void usedVariables(AST::Node *stmt, std::vector<Symbol> &uses) {
+	// an alternative's statements are blocks of their own
+	if (stmt->type == TYPE_ALTERNATIVE) return;
+	if (stmt->type == LOAD) {
+		AST::Node *ident = stmt->get(IDENT);
+		if (ident != NULL) {
+			Symbol id = ident->symbol;
+			if (id != SYM_THIS && id != SYM_TRUE && id != SYM_FALSE && id != SYM_NONE) uses.push_back(id);
+			return;
+		}
+	}
+	for (AST::Node *child : stmt->rawChildren) {
+		usedVariables(child, uses);
+	}
+}
+
+// gen is what a block assigns, and nothing is ever unassigned
+static DataflowProblem assignedOnEveryPath(const ControlFlowGraph &cfg, SlotTable &table,
+								const SlotSet &boundary, Symbol (*assigned)(AST::Node*)) {
+	DataflowProblem problem;
+	problem.boundary = boundary;
+	problem.gen.resize(cfg.blocks.size());
+	problem.kill.resize(cfg.blocks.size());
+	for (auto &block : cfg.blocks) {
+		for (AST::Node *stmt : block->stmts) {
+			Symbol id = assigned(stmt);
+			if (id != NO_SYMBOL) problem.gen[block->id].insert(table.slotFor(id));
+		}
+	}
+	problem.slots = table.size();
+	return problem;
+}
+
+DataflowProblem initializedVariables(const ControlFlowGraph &cfg, SlotTable &locals, const SlotSet &args) {
+	return assignedOnEveryPath(cfg, locals, args, assignedVariable);
+}
+
+DataflowProblem initializedFields(const ControlFlowGraph &cfg, SlotTable &fields, const SlotSet &known) {
+	return assignedOnEveryPath(cfg, fields, known, assignedField);
+}
+
+DataflowProblem liveVariables(const ControlFlowGraph &cfg, const SlotTable &locals) {
+	DataflowProblem problem;
+	problem.forward = false;
+	problem.must = false;
+	problem.slots = locals.size();
+	problem.gen.resize(cfg.blocks.size());
+	problem.kill.resize(cfg.blocks.size());
+
+	// from the bottom of the block up: a read makes a variable live, an assignment
+	// makes it dead again above there. a statement reads before it assigns
+	std::vector<Symbol> uses;
+	for (auto &block : cfg.blocks) {
+		SlotSet &gen = problem.gen[block->id];
+		SlotSet &kill = problem.kill[block->id];
+		for (auto stmt = block->stmts.rbegin(); stmt != block->stmts.rend(); ++stmt) {
+			int def = locals.find(assignedVariable(*stmt));
+			if (def >= 0) {
+				SlotSet just;
+				just.insert(def);
+				gen.remove(just);
+				kill.insert(def);
+			}
+			uses.clear();
+			usedVariables(*stmt, uses);
+			for (Symbol use : uses) {
+				int slot = locals.find(use);
+				if (slot >= 0) gen.insert(slot);
+			}
+		}
+	}
+	return problem;
+}
+
+DataflowProblem reachingDefinitions(const ControlFlowGraph &cfg, std::vector<AST::Node*> &definitions) {
+	DataflowProblem problem;
+	problem.must = false;
+	problem.gen.resize(cfg.blocks.size());
+	problem.kill.resize(cfg.blocks.size());
+
+	// every assignment to a variable kills the others
+	std::map<Symbol, SlotSet> assignmentsTo;
+	for (auto &block : cfg.blocks) {
+		for (AST::Node *stmt : block->stmts) {
+			Symbol id = assignedVariable(stmt);
+			if (id == NO_SYMBOL) continue;
+			assignmentsTo[id].insert((int) definitions.size());
+			definitions.push_back(stmt);
+		}
+	}
+
+	int def = 0;
+	for (auto &block : cfg.blocks) {
+		SlotSet &gen = problem.gen[block->id];
+		SlotSet &kill = problem.kill[block->id];
+		for (AST::Node *stmt : block->stmts) {
+			Symbol id = assignedVariable(stmt);
+			if (id == NO_SYMBOL) continue;
+			gen.remove(assignmentsTo[id]);
+			gen.insert(def);
+			kill |= assignmentsTo[id];
+			def++;
+		}
+	}
+	problem.slots = definitions.size();
+	return problem;
+}
@@ -0,0 +1,55 @@
+#ifndef DATAFLOW_H
+#define DATAFLOW_H
+
+#include <vector>
+#include "ASTNode.h"
+#include "cfg.h"
+#include "slotset.h"
+
+// A bitvector dataflow problem over a ControlFlowGraph. Facts are sets of slots,
+// and each block turns the facts at its top into out = gen + (in - kill) at its
+// bottom (a backward problem goes from the bottom up instead). Where paths come
+// together, a must problem keeps only what holds on all of them (like "definitely
+// initialized"), and a may problem keeps what holds on any (like "live").
+struct DataflowProblem {
+        bool forward = true;
+        bool must = true;
+        // how many slots there are. in a must problem, facts start out as all of them
+        size_t slots = 0;
+        // what holds at the entry (forward) or at the exit (backward)
+        SlotSet boundary;
+        // by block id
+        std::vector<SlotSet> gen;
+        std::vector<SlotSet> kill;
+};
+
+// what holds at the top and at the bottom of each block, by block id
+struct DataflowResult {
+        std::vector<SlotSet> in;
+        std::vector<SlotSet> out;
+};
+
+// works blocks off a worklist in reverse postorder (postorder for backward
+// problems) until nothing changes
+DataflowResult solveDataflow(const ControlFlowGraph &cfg, const DataflowProblem &problem);
+
+// what a simple statement does to a method's variables: the local it assigns (an
+// assignment, or a typecase alternative's variable), the field it assigns
+// ("this.x = ..."), or NO_SYMBOL, and the locals it reads, in order
+Symbol assignedVariable(AST::Node *stmt);
+Symbol assignedField(AST::Node *stmt);
+void usedVariables(AST::Node *stmt, std::vector<Symbol> &uses);
+
+// the locals (or fields) that are definitely assigned, on every path there. locals
+// and fields give a slot to everything that gets assigned
+DataflowProblem initializedVariables(const ControlFlowGraph &cfg, SlotTable &locals, const SlotSet &args);
+DataflowProblem initializedFields(const ControlFlowGraph &cfg, SlotTable &fields, const SlotSet &known);
+
+// the locals that might still be read before they are next assigned
+DataflowProblem liveVariables(const ControlFlowGraph &cfg, const SlotTable &locals);
+
+// the assignments to locals whose value might still be there, where each one's slot is
+// its place in definitions (the assignments, in the order they come in the method)
+DataflowProblem reachingDefinitions(const ControlFlowGraph &cfg, std::vector<AST::Node*> &definitions);
+
+#endif
@@ -5,7 +5,16 @@
 #include "typechecker.h"
 #include "stubs.h"
 #include "codegen.h"
-#include <fstream>
+#include "cache.h"
+#include "sourcefile.h"
+#include <sstream>
+#include <chrono>
+#include <dirent.h>
+#include <climits>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 class Driver {
   public:
@@ -16,8 +25,10 @@ class Driver {
     //    lexer         : used to override the default lexer in bison (yylex) when parsing
     //    &root         : given to the parser and initialized to the root Node when parsing.
     //                    used to pass the Node back here.
+    //    arena         : where the parser allocates the AST. it belongs to the caller, so
+    //                    the AST outlives the Driver and is freed with the arena
 
-    explicit Driver(reflex::Input in) : lexer(in), parser(new yy::parser(lexer, &root)) {
+    Driver(reflex::Input in, Arena &arena) : lexer(in), parser(new yy::parser(lexer, &root, arena)) {
         root = nullptr;
     }
 
@@ -53,19 +64,134 @@ class Driver {
 
 void printUsage() {
     report::rnote("Usage: ./qcc [filename].qk", PROMPT);
-    report::rnote("\t*use flag: --json=true for JSON output", PROMPT);
-    report::rnote("\t*use flag: --no-debug to hide compile stage messages", PROMPT);
+    report::rnote("\t*use - as the filename to read the program from stdin", PROMPT);
+    report::rnote("\t*use flag: -json for JSON output", PROMPT);
+    report::rnote("\t*use flag: -debug to show compile stage messages", PROMPT);
+    report::rnote("\t*use flag: -O0, -O1, -O2, -O3 to pick the C compiler's optimization level (default -O0)", PROMPT);
+    report::rnote("\t*use flag: -time to report how long the front end and the C compiler each took", PROMPT);
+    report::rnote("\t*use flag: -run to run the program as soon as it is built", PROMPT);
+    report::rnote("\t*use flag: -rt=release, -rt=debug, -rt=instrumented to pick the prebuilt runtime (default release)", PROMPT);
+    report::rnote("\t*use flag: -flto to optimize the program and Builtins together at link time (defaults to -O2)", PROMPT);
+    report::rnote("\t*use flag: -pgo=generate[=dir] to build a program that records a profile when run (default dir QuackOutput.pgo)", PROMPT);
+    report::rnote("\t*use flag: -pgo=use=dir to rebuild the program with that profile (both -pgo modes default to -O2)", PROMPT);
+    report::rnote("\t*use flag: -cache to reuse the build of an unchanged program (-cache-stats on its own for statistics)", PROMPT);
+    report::rnote("\t*use flag: -j or -j[N] to split the output into a file per class and compile N at a time (default: one per core)", PROMPT);
+    report::rnote("\t*use flag: -threads=N to type check and generate code on N threads (default: one per core, the output is the same either way)", PROMPT);
 }
 
-int main(int argc, char *argv[]) {
-    if (argc > 4) {
-        report::rnote("Invalid number of arguments.", PROMPT);
-        printUsage();
-        report::bail(PROMPT);
+// milliseconds elapsed since start, for the -time flag
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+// starts a program without waiting for it. args[0] is looked up on the PATH,
+// and no shell is involved. returns the child's pid, or -1 if it could not fork
+pid_t startCommand(std::vector<std::string> args) {
+    std::vector<char *> argv;
+    for (std::string &arg : args) {
+        argv.push_back(&arg[0]);
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        execvp(argv[0], argv.data());
+        _exit(127); // only reached if the exec failed
     }
+    return pid;
+}
+
+// runs a program and waits for it to finish. returns the program's exit status,
+// or -1 if it could not be started or did not exit normally
+int runCommand(std::vector<std::string> args) {
+    pid_t pid = startCommand(args);
+    if (pid < 0) return -1;
+
+    int status;
+    if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status)) return -1;
+    return WEXITSTATUS(status);
+}
 
+// makes the directory for -pgo=generate, and throws out the profile of the last
+// training run so that it doesn't get mixed in with the new one
+void resetProfileDir(std::string dir) {
+    mkdir(dir.c_str(), 0755);
+    DIR *d = opendir(dir.c_str());
+    if (!d) return;
+    while (struct dirent *ent = readdir(d)) {
+        std::string name = ent->d_name;
+        if (name == "quack.profile" || (name.size() > 5 && name.compare(name.size() - 5, 5, ".gcda") == 0)) {
+            unlink((dir + "/" + name).c_str());
+        }
+    }
+    closedir(d);
+}
+
+// hand the terminal over to the program, and pass its exit status back out as ours
+void runAndExit() {
+    int status = runCommand({"./QuackOutput"});
+    exit(status == -1 ? 1 : status);
+}
+
+// compiles every source file to an object file with at most jobs gcc processes running
+// at once, then links them and the libraries into QuackOutput. returns false if any step failed
+bool compileParallel(std::vector<std::string> sources, std::vector<std::string> libraries,
+                     std::vector<std::string> gccFlags, int jobs) {
+    std::vector<std::string> objects;
+    size_t next = 0;
+    int running = 0;
+    bool ok = true;
+
+    while (next < sources.size() || running > 0) {
+        // keep the pool full, unless something already failed
+        while (ok && running < jobs && next < sources.size()) {
+            std::string source = sources[next++];
+            // Builtins gets a name no generated class file can have
+            std::string object = (source == "src/Builtins.c") ? "QuackOutput-Builtins.o"
+                                 : source.substr(0, source.rfind(".c")) + ".o";
+            objects.push_back(object);
+            std::vector<std::string> compile = {"gcc", "-pipe"};
+            compile.insert(compile.end(), gccFlags.begin(), gccFlags.end());
+            compile.insert(compile.end(), {"-c", source, "-Isrc", "-w", "-o", object});
+            if (startCommand(compile) < 0) {
+                ok = false;
+            } else {
+                ++running;
+            }
+        }
+        if (running == 0) break;
+
+        int status;
+        if (waitpid(-1, &status, 0) < 0) return false;
+        --running;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) ok = false;
+    }
+    if (!ok) return false;
+
+    std::vector<std::string> link = {"gcc"};
+    link.insert(link.end(), gccFlags.begin(), gccFlags.end());
+    link.push_back("-o");
+    link.push_back("QuackOutput");
+    link.insert(link.end(), objects.begin(), objects.end());
+    link.insert(link.end(), libraries.begin(), libraries.end());
+    return runCommand(link) == 0;
+}
+
+int main(int argc, char *argv[]) {
     std::string filename;
     bool json = false;
+    bool timing = false;
+    bool run = false;
+    std::string optLevel = "-O0"; // unoptimized C is the fastest to build
+    int jobs = 0; // 0 = one QuackOutput.c built by a single gcc
+    int threads = ThreadPool::defaultSize();
+    bool useCache = false;
+    bool optGiven = false;
+    bool lto = false;
+    std::string runtimeVariant = "release";
+    std::string pgo; // "", "generate", or "use"
+    std::string pgoDir = "QuackOutput.pgo";
 
     // Get our filename arg and optional flags
     for (int i = 1; i < argc; i++) {
@@ -78,33 +204,138 @@ int main(int argc, char *argv[]) {
             report::setGenerateImage(true);
         } else if (std::strcmp(argv[i], "-verbose") == 0) {
             report::setVerbose(true);
+        } else if (std::strcmp(argv[i], "-time") == 0) {
+            timing = true;
+        } else if (std::strcmp(argv[i], "-run") == 0) {
+            run = true;
+        } else if (std::strcmp(argv[i], "-cache") == 0) {
+            useCache = true;
+        } else if (std::strcmp(argv[i], "-cache-stats") == 0) {
+            Cache().printStats();
+            exit(0);
+        } else if (std::strcmp(argv[i], "-O0") == 0 || std::strcmp(argv[i], "-O1") == 0 ||
+                   std::strcmp(argv[i], "-O2") == 0 || std::strcmp(argv[i], "-O3") == 0) {
+            optLevel = std::string(argv[i]);
+            optGiven = true;
+        } else if (std::strcmp(argv[i], "-rt=release") == 0 || std::strcmp(argv[i], "-rt=debug") == 0 ||
+                   std::strcmp(argv[i], "-rt=instrumented") == 0) {
+            runtimeVariant = std::string(argv[i] + 4);
+        } else if (std::strcmp(argv[i], "-flto") == 0) {
+            lto = true;
+        } else if (std::strncmp(argv[i], "-pgo=generate", 13) == 0) {
+            pgo = "generate";
+            if (argv[i][13] == '=') pgoDir = std::string(argv[i] + 14);
+        } else if (std::strncmp(argv[i], "-pgo=use=", 9) == 0) {
+            pgo = "use";
+            pgoDir = std::string(argv[i] + 9);
+        } else if (std::strncmp(argv[i], "-j", 2) == 0) {
+            jobs = (argv[i][2] == '\0') ? (int) sysconf(_SC_NPROCESSORS_ONLN) : std::atoi(argv[i] + 2);
+            if (jobs < 1) jobs = 1;
+        } else if (std::strncmp(argv[i], "-threads=", 9) == 0) {
+            threads = std::atoi(argv[i] + 9);
+            if (threads < 1) threads = 1;
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            report::rnote("Invalid flag \"" + std::string(argv[i]) + "\"", PROMPT);
+            printUsage();
+            report::bail(PROMPT);
+        } else if (filename.empty()) {
+            filename = std::string(argv[i]); // "-" is stdin
         } else {
-            filename = std::string(argv[i]);
+            // only one program at a time
+            report::rnote("Invalid number of arguments.", PROMPT);
+            printUsage();
+            report::bail(PROMPT);
         }
     }
 
-    // Open file to pass to Driver
-    std::ifstream file;
-    file.open(filename);
+    // the gcc flags that decide what gets built, and so what goes into the cache key
+    std::vector<std::string> gccFlags;
+    if (!pgo.empty()) {
+        // the profile's location is built into the program, so it has to be absolute. a
+        // -pgo=use directory that isn't there is left as it is, and the build goes on
+        // without a profile once the code generator finds nothing in it
+        char resolved[PATH_MAX];
+        if (pgo == "generate") {
+            resetProfileDir(pgoDir);
+            if (realpath(pgoDir.c_str(), resolved) == nullptr) {
+                report::rnote("Invalid profile directory \"" + pgoDir + "\"", PROMPT);
+                exit(1);
+            }
+            pgoDir = resolved;
+        } else if (realpath(pgoDir.c_str(), resolved) != nullptr) {
+            pgoDir = resolved;
+        }
+        // gcc can only match its profile to a build made with the same -O level
+        if (!optGiven) optLevel = "-O2";
+        // a profile changes every time the program is trained, so these builds aren't cached
+        useCache = false;
+    }
+    // with the runtime in a separate translation unit, calls like int_literal can only be
+    // inlined into the generated code when gcc optimizes the whole program at link time
+    if (lto && !optGiven) optLevel = "-O2";
+    gccFlags.push_back(optLevel);
+    if (lto) gccFlags.push_back("-flto");
+    // the generated code is built the same way as the runtime it's linked with
+    if (runtimeVariant == "debug") gccFlags.push_back("-g");
+    if (runtimeVariant == "instrumented") {
+        gccFlags.insert(gccFlags.end(), {"-g", "-fsanitize=address,undefined", "-fno-omit-frame-pointer"});
+    }
 
-    if (!file.is_open()) {
+    // link the runtime that build.sh left in lib/ instead of compiling Builtins.c every time.
+    // -flto and -pgo builds need Builtins.c compiled with their own flags, so they still use
+    // the source, as does a tree where the runtime was never built
+    std::string runtime = "lib/libquackrt" + (runtimeVariant == "release" ? "" : "_" + runtimeVariant) + ".a";
+    if (lto || !pgo.empty() || access(runtime.c_str(), R_OK) != 0) {
+        runtime = "src/Builtins.c";
+    }
+    if (pgo == "generate") gccFlags.push_back("-fprofile-generate=" + pgoDir);
+    if (pgo == "use") {
+        gccFlags.push_back("-fprofile-use=" + pgoDir);
+        // taking qcc's counters back out can let gcc simplify a function differently, so
+        // its shape no longer matches the profile. gcc then falls back to qcc's hints for it
+        gccFlags.push_back("-Wno-coverage-mismatch");
+    }
+
+    // Open file to pass to Driver. the lexer reads it straight out of memory,
+    // mapped if it's a regular file
+    SourceFile file;
+
+    if (filename.empty() || !file.open(filename)) {
         std::cerr << "\033[1;91m" << "Invalid file or flag \"" << filename << "\"\033[0m" << std::endl;
         printUsage();
         exit(1);
     }
 
-    Driver driver(file);
+    auto frontEndStart = std::chrono::steady_clock::now();
+    // the program's AST and the builtin stubs' all go in here
+    Arena arena;
+    Driver driver(reflex::Input(file.data(), file.size()), arena);
     
     report::ynote("starting...", LEXER);
     report::ynote("starting...", PARSER);
     // Parse and get AST into *root
+    auto parseStart = std::chrono::steady_clock::now();
     AST::Node* root = driver.parse();
+    double parseMs = elapsedMs(parseStart);
     if (root != nullptr) {
-        Driver stubsDriver(STUBS);
+        Driver stubsDriver(STUBS, arena);
         AST::Node* stubsRoot = stubsDriver.parse();
 
         report::gnote("complete.", LEXER);
         report::gnote("complete.", PARSER);
+        if (report::getVerbose()) {
+            // the lexer runs as the parser asks for tokens, so this is the two together
+            if (parseMs > 0) {
+                std::stringstream rate;
+                rate.precision(1);
+                rate << std::fixed << "lexed and parsed " << file.size() / 1024 << " KB "
+                     << (file.isMapped() ? "(mapped)" : "(read in)") << " at "
+                     << (file.size() / (1024.0 * 1024.0)) / (parseMs / 1000) << " MB/s";
+                report::note(rate.str(), LEXER);
+            }
+            report::note("the AST takes " + std::to_string(arena.used() / 1024) + " KB (" 
+                + std::to_string(arena.reserved() / 1024) + " KB reserved)", PARSER);
+        }
         AST::AST_print_context context;
 
         if (json) {
@@ -112,9 +343,31 @@ int main(int argc, char *argv[]) {
             std::cout << std::endl;
         } 
 
+        // a program that was already built by this qcc and gcc, against the same Builtins
+        // and with the same flags, is copied out of the cache instead of being rebuilt.
+        // the AST is hashed rather than the file, so comments and whitespace don't matter.
+        // it's serialized in source order: the JSON groups children by type, so two
+        // programs with the same statements in a different order print the same
+        Cache cache;
+        if (useCache) {
+            std::string program;
+            root->serialize(program);
+            std::vector<std::string> keyFlags = gccFlags;
+            keyFlags.push_back(jobs > 0 ? "split" : "single");
+            cache.computeKey(program, keyFlags, {runtime});
+            if (cache.lookup()) {
+                report::gnote("found in the cache. Your outputted program is named QuackOutput!", CODEGENERATION);
+                if (timing) {
+                    std::cerr << "qcc: " << elapsedMs(frontEndStart) << " ms, gcc " << optLevel << ": 0 ms (cached)" << std::endl;
+                }
+                if (run) runAndExit();
+                exit(0);
+            }
+        }
+
         // begin type checking on our non-null AST
         report::ynote("starting...", TYPECHECKER);
-        Typechecker typeChecker(root, stubsRoot);
+        Typechecker typeChecker(root, stubsRoot, threads);
         bool programValid = typeChecker.checkProgram();
 
         report::dynamicBail();
@@ -123,15 +376,62 @@ int main(int argc, char *argv[]) {
 
 
         report::ynote("starting...", CODEGENERATION);
-        CodeGenerator codeGenerator(&typeChecker, std::string("QuackOutput.c"));
+        CodeGenerator codeGenerator(&typeChecker, std::string("QuackOutput.c"), jobs > 0);
+        codeGenerator.profileGenerate = (pgo == "generate");
+        codeGenerator.profilePath = pgoDir + "/quack.profile";
+        if (pgo == "use" && !codeGenerator.loadProfile(codeGenerator.profilePath)) {
+            report::rnote("no profile in " + pgoDir + ", run the -pgo=generate build first. building without it.", CODEGENERATION);
+        }
         bool codeGenerated = codeGenerator.generate();
 
         report::dynamicBail();
+        double frontEndMs = elapsedMs(frontEndStart);
         if (codeGenerated) {
             report::gnote("generation of QuackOutput.c complete.", CODEGENERATION);
             report::ynote("starting GCC invocation...", CODEGENERATION);
-            system("scripts/invoke_gcc.sh");
-            report::gnote("complete. Your outputted program is named QuackOutput!", CODEGENERATION);
+            auto backEndStart = std::chrono::steady_clock::now();
+            bool compiled;
+            if (jobs > 0) {
+                std::vector<std::string> sources;
+                std::vector<std::string> libraries;
+                if (runtime == "src/Builtins.c") {
+                    // Builtins.c is the biggest file, so it gets a head start
+                    sources.push_back(runtime);
+                } else {
+                    libraries.push_back(runtime);
+                }
+                sources.insert(sources.end(), codeGenerator.sourceFiles.begin(), codeGenerator.sourceFiles.end());
+                compiled = compileParallel(sources, libraries, gccFlags, jobs);
+            } else {
+                // same command as scripts/invoke_gcc.sh, but started directly instead of through a shell
+                std::vector<std::string> compile = {"gcc", "-pipe"};
+                compile.insert(compile.end(), gccFlags.begin(), gccFlags.end());
+                compile.insert(compile.end(), {"QuackOutput.c", runtime, "-Isrc", "-w", "-o", "QuackOutput"});
+                compiled = runCommand(compile) == 0;
+            }
+            double backEndMs = elapsedMs(backEndStart);
+            if (!compiled) {
+                report::rnote("GCC could not compile QuackOutput.c!", CODEGENERATION);
+            } else {
+                report::gnote("complete. Your outputted program is named QuackOutput!", CODEGENERATION);
+                if (useCache) {
+                    std::vector<std::string> outputs = {"QuackOutput", "QuackOutput.c"};
+                    if (jobs > 0) {
+                        outputs = codeGenerator.sourceFiles;
+                        outputs.push_back("QuackOutput.h");
+                        outputs.push_back("QuackOutput");
+                    }
+                    cache.store(outputs);
+                }
+            }
+
+            if (timing) {
+                std::cerr << "qcc: " << frontEndMs << " ms, gcc " << optLevel << ": " << backEndMs << " ms" << std::endl;
+            }
+
+            // the timing is still worth printing, but a build gcc failed on is a failed compile
+            if (!compiled) report::bail(CODEGENERATION);
+            if (run) runAndExit();
         }
         // if codeGenerated is false it should have bailed in the code generator
 
@@ -141,6 +441,4 @@ int main(int argc, char *argv[]) {
         report::rnote("compilation failed - abstract syntax tree could not be generated!", PARSER);
         report::dynamicBail();
     }
-
-    file.close();
 }
\ No newline at end of file
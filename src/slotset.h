@@ -0,0 +1,131 @@
+#ifndef SLOTSET_H
+#define SLOTSET_H
+
+#include <algorithm>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include "symbols.h"
+
+// Dense slot numbers for the names a method (its locals) or a class (its fields)
+// keeps track of, handed out in the order the names are first seen.
+class SlotTable {
+	public:
+        /* ======= */
+        /* Methods */
+        /* ======= */
+
+        // the slot for a name, giving it the next one if it doesn't have one yet
+        int slotFor(Symbol name) {
+                auto slot = slots.find(name);
+                if (slot != slots.end()) return slot->second;
+                slots[name] = (int) names.size();
+                names.push_back(name);
+                return (int) names.size() - 1;
+        }
+
+        // the slot for a name, or -1 if it hasn't been given one
+        int find(Symbol name) const {
+                auto slot = slots.find(name);
+                return (slot == slots.end()) ? -1 : slot->second;
+        }
+
+        Symbol name(int slot) const { return names[slot]; }
+        size_t size() const { return names.size(); }
+
+	private:
+        std::unordered_map<int, int> slots;
+        std::vector<Symbol> names;
+};
+
+// A set of slots, one bit each, so that seeing whether a name is in it is a single
+// bit test and combining what two paths through a method did is a word-wise AND.
+class SlotSet {
+	public:
+        /* ======= */
+        /* Methods */
+        /* ======= */
+
+        // slot -1 (a name that was never given a slot) is never in the set
+        bool test(int slot) const {
+                if (slot < 0 || (size_t) slot / 64 >= words.size()) return false;
+                return (words[slot / 64] >> (slot % 64)) & 1;
+        }
+
+        void insert(int slot) {
+                if ((size_t) slot / 64 >= words.size()) words.resize(slot / 64 + 1, 0);
+                words[slot / 64] |= 1ULL << (slot % 64);
+        }
+
+        // keep only what's in both
+        SlotSet &operator&=(const SlotSet &other) {
+                if (words.size() > other.words.size()) words.resize(other.words.size());
+                for (size_t i = 0; i < words.size(); i++) {
+                        words[i] &= other.words[i];
+                }
+                return *this;
+        }
+
+        // add everything that's in other
+        SlotSet &operator|=(const SlotSet &other) {
+                if (words.size() < other.words.size()) words.resize(other.words.size(), 0);
+                for (size_t i = 0; i < other.words.size(); i++) {
+                        words[i] |= other.words[i];
+                }
+                return *this;
+        }
+
+        // take out everything that's in other
+        void remove(const SlotSet &other) {
+                size_t common = std::min(words.size(), other.words.size());
+                for (size_t i = 0; i < common; i++) {
+                        words[i] &= ~other.words[i];
+                }
+        }
+
+        bool operator==(const SlotSet &other) const {
+                size_t longest = std::max(words.size(), other.words.size());
+                for (size_t i = 0; i < longest; i++) {
+                        unsigned long long mine = (i < words.size()) ? words[i] : 0;
+                        unsigned long long theirs = (i < other.words.size()) ? other.words[i] : 0;
+                        if (mine != theirs) return false;
+                }
+                return true;
+        }
+        bool operator!=(const SlotSet &other) const { return !(*this == other); }
+
+        // slots 0 .. count - 1
+        static SlotSet all(size_t count) {
+                SlotSet set;
+                set.words.assign(count / 64, ~0ULL);
+                if (count % 64 != 0) set.words.push_back((1ULL << (count % 64)) - 1);
+                return set;
+        }
+
+        void clear() { words.clear(); }
+
+        // the smallest slot in this set that isn't in other, or -1 if there isn't one
+        int firstNotIn(const SlotSet &other) const {
+                for (size_t i = 0; i < words.size(); i++) {
+                        unsigned long long only = words[i] & ~((i < other.words.size()) ? other.words[i] : 0);
+                        if (only != 0) return (int) (i * 64 + __builtin_ctzll(only));
+                }
+                return -1;
+        }
+
+        // every slot in the set, smallest first
+        std::vector<int> slots() const {
+                std::vector<int> all;
+                for (size_t i = 0; i < words.size(); i++) {
+                        for (unsigned long long word = words[i]; word != 0; word &= word - 1) {
+                                all.push_back((int) (i * 64 + __builtin_ctzll(word)));
+                        }
+                }
+                return all;
+        }
+
+	private:
+        std::vector<unsigned long long> words;
+};
+
+#endif
@@ -0,0 +1,57 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "sourcefile.h"
+
+SourceFile::~SourceFile() {
+	if (mapped != NULL) munmap((void*) mapped, mappedSize);
+}
+
+bool SourceFile::open(const std::string &filename) {
+	if (filename == "-") return readAll(STDIN_FILENO);
+
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat info;
+	if (fstat(fd, &info) < 0 || S_ISDIR(info.st_mode)) {
+		close(fd);
+		return false;
+	}
+
+	// an empty file can't be mapped, and there's nothing to map anyway
+	bool ok;
+	if (S_ISREG(info.st_mode) && info.st_size > 0) {
+		void *text = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (text != MAP_FAILED) {
+			// the lexer goes through it once, front to back
+			madvise(text, info.st_size, MADV_SEQUENTIAL);
+			mapped = (const char*) text;
+			mappedSize = info.st_size;
+			ok = true;
+		} else {
+			ok = readAll(fd);
+		}
+	} else {
+		ok = readAll(fd);
+	}
+	close(fd);
+	return ok;
+}
+
+// reads until the end of the input, in as few reads as it will give
+bool SourceFile::readAll(int fd) {
+	struct stat info;
+	if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+		contents.reserve(info.st_size);
+	}
+
+	char chunk[1 << 16];
+	for (;;) {
+		ssize_t got = read(fd, chunk, sizeof(chunk));
+		if (got == 0) return true;
+		if (got < 0) return false;
+		contents.append(chunk, got);
+	}
+}
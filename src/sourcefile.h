@@ -0,0 +1,47 @@
+#ifndef SOURCEFILE_H
+#define SOURCEFILE_H
+
+#include <cstddef>
+#include <string>
+
+// The text of the program being compiled. A regular file is mapped into memory
+// read-only, so the lexer reads it where it is; anything else (stdin, given as
+// "-", or a pipe) can't be mapped and is read in one go instead.
+class SourceFile {
+	public:
+        /* ========================== */
+        /* Constructors & Destructors */
+        /* ========================== */
+
+        SourceFile() {};
+        virtual ~SourceFile();
+        SourceFile(const SourceFile&) = delete;
+        SourceFile &operator=(const SourceFile&) = delete;
+
+        /* ======= */
+        /* Methods */
+        /* ======= */
+
+        // false if the file can't be opened or read
+        bool open(const std::string &filename);
+
+        // the whole text, valid for as long as the SourceFile is
+        const char *data() const { return mapped != NULL ? mapped : contents.data(); }
+        size_t size() const { return mapped != NULL ? mappedSize : contents.size(); }
+
+        // whether the text is a mapping of the file rather than a copy
+        bool isMapped() const { return mapped != NULL; }
+
+	private:
+        /* ============ */
+        /* Data Members */
+        /* ============ */
+
+        const char *mapped = NULL;
+        size_t mappedSize = 0;
+        std::string contents; // when it couldn't be mapped
+
+        bool readAll(int fd);
+};
+
+#endif
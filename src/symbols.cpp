@@ -0,0 +1,76 @@
+#include "symbols.h"
+#include <cstring>
+
+SymbolTable symbols;
+
+// FNV-1a
+static unsigned int hashName(const char *text, size_t length) {
+	unsigned int hash = 2166136261u;
+	for (size_t i = 0; i < length; i++) {
+		hash ^= (unsigned char) text[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+SymbolTable::SymbolTable() : slots(256, NO_SYMBOL) {
+	// same order as the Symbol enum
+	const char *predefined[] = {
+		"Obj", "Int", "String", "Boolean", "Nothing",
+		"this", "true", "false", "none", "return",
+		"$UNKNOWN", "$MAIN"
+	};
+	for (const char *name : predefined) {
+		intern(name, std::strlen(name));
+	}
+}
+
+Symbol SymbolTable::intern(const char *text, size_t length) {
+	unsigned int hash = hashName(text, length);
+	size_t slot = slotFor(text, length, hash);
+	if (slots[slot] != NO_SYMBOL) {
+		return slots[slot];
+	}
+
+	Symbol symbol = (Symbol) names.size();
+	names.emplace_back(text, length);
+	hashes.push_back(hash);
+	slots[slot] = symbol;
+
+	// keep the table at most half full so probe runs stay short
+	if (names.size() * 2 > slots.size()) {
+		grow();
+	}
+	return symbol;
+}
+
+Symbol SymbolTable::find(const std::string &text) const {
+	return slots[slotFor(text.data(), text.size(), hashName(text.data(), text.size()))];
+}
+
+// the slot holding this name, or the empty slot it would go in
+size_t SymbolTable::slotFor(const char *text, size_t length, unsigned int hash) const {
+	size_t mask = slots.size() - 1;
+	for (size_t slot = hash & mask; ; slot = (slot + 1) & mask) {
+		Symbol symbol = slots[slot];
+		if (symbol == NO_SYMBOL) {
+			return slot;
+		}
+		const std::string &name = names[symbol];
+		if (hashes[symbol] == hash && name.size() == length && std::memcmp(name.data(), text, length) == 0) {
+			return slot;
+		}
+	}
+}
+
+void SymbolTable::grow() {
+	slots.assign(slots.size() * 2, NO_SYMBOL);
+	size_t mask = slots.size() - 1;
+	for (size_t symbol = 0; symbol < names.size(); symbol++) {
+		size_t slot = hashes[symbol] & mask;
+		while (slots[slot] != NO_SYMBOL) {
+			slot = (slot + 1) & mask;
+		}
+		slots[slot] = (Symbol) symbol;
+	}
+}
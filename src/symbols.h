@@ -0,0 +1,68 @@
+#ifndef SYMBOLS_H
+#define SYMBOLS_H
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <vector>
+
+// A Symbol is a small integer standing in for a name (an identifier, a class,
+// a method, a string literal). Two names are the same exactly when their
+// symbols are, so comparing and looking things up by name never has to touch
+// the characters. The names every program uses are interned first, so that
+// they have fixed ids that can be used directly in the code.
+enum Symbol : int {
+        NO_SYMBOL = -1,
+
+        // the built-in classes
+        SYM_OBJ, SYM_INT, SYM_STRING, SYM_BOOLEAN, SYM_NOTHING,
+
+        // names with a special meaning to the typechecker
+        SYM_THIS, SYM_TRUE, SYM_FALSE, SYM_NONE, SYM_RETURN,
+        SYM_UNKNOWN, SYM_MAIN,
+
+        NUM_PREDEFINED_SYMBOLS
+};
+
+class SymbolTable {
+	public:
+        /* ========================== */
+        /* Constructors & Destructors */
+        /* ========================== */
+
+        SymbolTable();
+        virtual ~SymbolTable() { };
+
+        /* ======= */
+        /* Methods */
+        /* ======= */
+
+        // the symbol for a name, adding it if this is the first time it's been seen
+        Symbol intern(const char *text, size_t length);
+        Symbol intern(const std::string &text) { return intern(text.data(), text.size()); }
+
+        // the symbol for a name, or NO_SYMBOL if it has never been interned
+        Symbol find(const std::string &text) const;
+
+        // the name a symbol stands for. the reference stays good for the life of the table
+        const std::string &name(Symbol symbol) const { return names[symbol]; }
+
+        // how many symbols there are, for sizing tables indexed by symbol
+        size_t size() const { return names.size(); }
+
+	private:
+        // a deque, so growing it never moves the names already handed out
+        std::deque<std::string> names;
+        std::vector<unsigned int> hashes;
+
+        // open addressing over the symbols, NO_SYMBOL where a slot is empty
+        std::vector<Symbol> slots;
+
+        size_t slotFor(const char *text, size_t length, unsigned int hash) const;
+        void grow();
+};
+
+// the one table shared by the lexer, the typechecker, and codegen
+extern SymbolTable symbols;
+
+#endif
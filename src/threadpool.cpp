@@ -0,0 +1,75 @@
+#include "threadpool.h"
+
+ThreadPool::ThreadPool(int threads) : next(0) {
+	for (int i = 1; i < threads; i++) {
+		workers.emplace_back(&ThreadPool::work, this);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (std::thread &worker : workers) {
+		worker.join();
+	}
+}
+
+int ThreadPool::defaultSize() {
+	unsigned int cores = std::thread::hardware_concurrency();
+	return (cores == 0) ? 1 : (int) cores;
+}
+
+void ThreadPool::forEach(size_t count, const std::function<void(size_t)> &task) {
+	// not worth waking anyone up for
+	if (workers.empty() || count <= 1) {
+		for (size_t i = 0; i < count; i++) {
+			task(i);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		this->task = &task;
+		this->count = count;
+		next = 0;
+		busy = (int) workers.size();
+		++round;
+	}
+	wake.notify_all();
+	drain();
+
+	std::unique_lock<std::mutex> guard(lock);
+	done.wait(guard, [this] { return busy == 0; });
+	this->task = NULL;
+}
+
+void ThreadPool::work() {
+	unsigned long seen = 0;
+	std::unique_lock<std::mutex> guard(lock);
+	while (true) {
+		wake.wait(guard, [this, seen] { return stopping || round != seen; });
+		if (stopping) {
+			return;
+		}
+		seen = round;
+
+		guard.unlock();
+		drain();
+		guard.lock();
+
+		if (--busy == 0) {
+			done.notify_all();
+		}
+	}
+}
+
+// take indices until there are none left
+void ThreadPool::drain() {
+	for (size_t i = next++; i < count; i = next++) {
+		(*task)(i);
+	}
+}
@@ -0,0 +1,58 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads, started once and reused, for fanning
+// independent pieces of work (checking a class, generating a method) out
+// across cores. The thread that hands the work out helps with it too, so a
+// pool of one thread just runs everything in place.
+class ThreadPool {
+	public:
+        /* ========================== */
+        /* Constructors & Destructors */
+        /* ========================== */
+
+        explicit ThreadPool(int threads);
+        virtual ~ThreadPool();
+
+        /* ======= */
+        /* Methods */
+        /* ======= */
+
+        // run task(0) .. task(count - 1), each on whichever thread is free next, and
+        // return once they have all finished. tasks mustn't hand out more work themselves
+        void forEach(size_t count, const std::function<void(size_t)> &task);
+
+        // how many threads work runs on, counting the caller
+        int size() const { return (int) workers.size() + 1; }
+
+        // one per core, for when the user doesn't say
+        static int defaultSize();
+
+	private:
+        std::vector<std::thread> workers;
+
+        std::mutex lock;
+        std::condition_variable wake;
+        std::condition_variable done;
+
+        // the work being handed out, the next index to take, and how many workers are still on it
+        const std::function<void(size_t)> *task = NULL;
+        size_t count = 0;
+        std::atomic<size_t> next;
+        int busy = 0;
+        unsigned long round = 0;
+        bool stopping = false;
+
+        void work();
+        void drain();
+};
+
+#endif
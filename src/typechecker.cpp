@@ -1,42 +1,15 @@
 #include "typechecker.h"
 
-std::vector<std::string> intersection(std::vector<std::string> vec1, std::vector<std::string> vec2) {
-    std::vector<std::string> ret_vec;
-
-    std::sort(vec1.begin(), vec1.end());
-    std::sort(vec2.begin(), vec2.end());
-
-    std::set_intersection(vec1.begin(), vec1.end(), vec2.begin(), vec2.end(), std::inserter(ret_vec, ret_vec.begin()));
-
-    return ret_vec;
-}
-
-// std::set_difference doesn't work properly... so I made my own simple version
-std::vector<std::string> difference(std::vector<std::string> vec1, std::vector<std::string> vec2) {
-	if (vec1.empty()) return vec2;
-	if (vec2.empty()) return vec1;
-    std::vector<std::string> ret_vec;
-
-    for (std::string v1 : vec1) {
-    	if ((std::find(vec2.begin(), vec2.end(), v1) == vec2.end())) ret_vec.push_back(v1);
-    }
-
-    for (std::string v2 : vec2) {
-    	if ((std::find(vec1.begin(), vec1.end(), v2) == vec1.end())) ret_vec.push_back(v2);
-    }
-
-    return ret_vec;
-}
-
 Qmethod* Typechecker::createQmethod(AST::Node *method, Qclass *containerClass, bool isConstructor) {
 	Qmethod *newMethod = new Qmethod();
 	newMethod->node = method;
 	newMethod->clazz = containerClass;
-	newMethod->name = method->get(IDENT, METHOD_NAME)->name;
+	newMethod->name = method->get(IDENT, METHOD_NAME)->name();
+	newMethod->id = method->get(IDENT, METHOD_NAME)->symbol;
 
 	// check for methods sharing a name with their class
 	if (!isConstructor) { // the name of a constructor is stored as the name of a class in the AST
-		if (newMethod->name == containerClass->name) {
+		if (newMethod->id == containerClass->id) {
 			RED << stageString(CLASSHIERARCHY) << "method " << newMethod->name << 
 						"() shares name with containing class" << END;
 	            	report::bail(CLASSHIERARCHY);
@@ -45,32 +18,32 @@ Qmethod* Typechecker::createQmethod(AST::Node *method, Qclass *containerClass, b
 
 	// check for duplicate methods
 	for (Qmethod* otherMethod : containerClass->methods) {
-		if (otherMethod->name == newMethod->name) {
+		if (otherMethod->id == newMethod->id) {
 			RED << stageString(CLASSHIERARCHY) << "method " << newMethod->name << 
 						"() in class \"" << containerClass->name << "\" is defined more than once" << END;
 	            	report::bail(CLASSHIERARCHY);
 		}
 	}
 
-	newMethod->type["return"] = method->get(IDENT, RETURN_TYPE)->name;
-	newMethod->argtype["return"] = method->get(IDENT, RETURN_TYPE)->name;
+	newMethod->type["return"] = method->get(IDENT, RETURN_TYPE)->name();
+	newMethod->argtype["return"] = method->get(IDENT, RETURN_TYPE)->name();
 
 	AST::Node *formalsContainer = method->get(FORMAL_ARGS);
-	if(!formalsContainer->order.empty()) { // empty formals check before iterating over it
-		std::vector<AST::Node *> formals = formalsContainer->getAll(CLASS_ARG);
+	if(!formalsContainer->rawChildren.empty()) { // empty formals check before iterating over it
+		AST::ChildRange formals = formalsContainer->getAll(CLASS_ARG);
 		for (AST::Node *arg : formals) {
-			std::string arg_name = arg->get(IDENT, VAR_IDENT)->name;
-			newMethod->init.push_back(arg_name);
+			std::string arg_name = arg->get(IDENT, VAR_IDENT)->name();
+			newMethod->init.insert(newMethod->locals.slotFor(arg->get(IDENT, VAR_IDENT)->symbol));
 			newMethod->args.push_back(arg_name);
 
-			std::string arg_type = arg->get(IDENT, TYPE_IDENT)->name;
+			std::string arg_type = arg->get(IDENT, TYPE_IDENT)->name();
 			newMethod->type[arg_name] = arg_type;
 			newMethod->argtype[arg_name] = arg_type;
 		}
 	}
 
 	AST::Node *stmts = method->get(BLOCK, STATEMENTS); // from the newMethod, grab all statements
-	if (!stmts->order.empty()) { // empty newMethod check before iterating over it
+	if (!stmts->rawChildren.empty()) { // empty newMethod check before iterating over it
 		for (AST::Node * stmt : method->get(BLOCK, STATEMENTS)->rawChildren) {
 			newMethod->stmts.push_back(stmt); // add each of these to the Qmethod in order
 		}
@@ -83,9 +56,11 @@ Qmethod* Typechecker::createQmethod(AST::Node *method, Qclass *containerClass, b
 Qclass* Typechecker::createQclass(AST::Node *clazz) {
 	Qclass *newClass = new Qclass();
 	newClass->node = clazz;
-	newClass->name = clazz->get(IDENT, CLASS_NAME)->name;
-	newClass->super = clazz->get(IDENT, SUPER_NAME)->name;
-	newClass->instanceVars.push_back("this");
+	newClass->name = clazz->get(IDENT, CLASS_NAME)->name();
+	newClass->super = clazz->get(IDENT, SUPER_NAME)->name();
+	newClass->id = clazz->get(IDENT, CLASS_NAME)->symbol;
+	newClass->superId = clazz->get(IDENT, SUPER_NAME)->symbol;
+	addInstanceVar(newClass, SYM_THIS);
 	newClass->instanceVarType["this"] = newClass->name;
 
 	// check to make sure the class isn't extending any of the "final" Quack built-in classes
@@ -101,8 +76,8 @@ Qclass* Typechecker::createQclass(AST::Node *clazz) {
 	newClass->constructor = classConstructor;
 
 	AST::Node *methodsContainer = clazz->get(METHODS);
-	if(!methodsContainer->order.empty()) { // empty methods check before iterating over it
-		std::vector<AST::Node *> methods = methodsContainer->getAll(METHOD);
+	if(!methodsContainer->rawChildren.empty()) { // empty methods check before iterating over it
+		AST::ChildRange methods = methodsContainer->getAll(METHOD);
 		for (AST::Node *method : methods) {
 			newClass->methods.push_back(createQmethod(method, newClass, false));
 		}
@@ -112,13 +87,13 @@ Qclass* Typechecker::createQclass(AST::Node *clazz) {
 }
 
 void Typechecker::initializeClasses(AST::Node *astRoot) {
-	bool haveClasses = !astRoot->get(CLASSES)->order.empty();
-	bool haveStatements = !astRoot->get(BLOCK, STATEMENTS)->order.empty();
+	bool haveClasses = !astRoot->get(CLASSES)->rawChildren.empty();
+	bool haveStatements = !astRoot->get(BLOCK, STATEMENTS)->rawChildren.empty();
 	// if we have an empty program, no type checking
 	if ( !haveClasses && !haveStatements) { return; }
 
 	if ( haveClasses ) { // only initialize our classes if we have some
-		std::vector<AST::Node *> classes = astRoot->get(CLASSES)->getAll(CLASS);
+		AST::ChildRange classes = astRoot->get(CLASSES)->getAll(CLASS);
 		for (AST::Node *n : classes) {
 			Qclass *clazz = createQclass(n);
 
@@ -130,6 +105,10 @@ void Typechecker::initializeClasses(AST::Node *astRoot) {
 			}
 
 			this->classes[clazz->name] = clazz;
+			if (this->classTable.size() <= (size_t) clazz->id) {
+				this->classTable.resize(clazz->id + 1, NULL);
+			}
+			this->classTable[clazz->id] = clazz;
 		}
 	}
 }
@@ -145,15 +124,18 @@ void Typechecker::initialize() {
 
 	AST::Node *main_stmts = this->root->get(BLOCK, STATEMENTS);
 	// build fake main if we have statements
-	if (!main_stmts->order.empty()) {
+	if (!main_stmts->rawChildren.empty()) {
 		Qclass *mainWrapper = new Qclass();
 		mainWrapper->node = main_stmts;
 		mainWrapper->name = "$MAIN";
 		mainWrapper->super = "$MAIN";
+		mainWrapper->id = SYM_MAIN;
+		mainWrapper->superId = SYM_MAIN;
 
 		Qmethod *mainConstructor = new Qmethod();
 		mainConstructor->clazz = mainWrapper;
 		mainConstructor->name = "$MAIN";
+		mainConstructor->id = SYM_MAIN;
 		for (AST::Node * stmt : main_stmts->rawChildren) {
 			mainConstructor->stmts.push_back(stmt); // add each of these to the Qmethod in order
 		}
@@ -165,10 +147,9 @@ void Typechecker::initialize() {
 		this->main = NULL;
 	}
 
-	// Initialize the class hierarchy table
+	// Initialize the class hierarchy (each class's subclasses)
 	std::string class_name;
 	std::string super_name;
-	std::map<std::string, std::vector<std::string>>::iterator it;
 
 	for (auto clss : this->classes) {
 		class_name = clss.second->name;
@@ -181,83 +162,147 @@ void Typechecker::initialize() {
         	report::bail(CLASSHIERARCHY);
 		}
 
-		it = this->class_hierarchy.find(super_name);
-		if (it == this->class_hierarchy.end()) {
-			std::vector<std::string> subs;
-			this->class_hierarchy.insert(std::pair<std::string, std::vector<std::string>>(super_name, subs));
+		// Obj is its own super, but not its own subclass
+		if (clss.second->superId != clss.second->id) {
+			findClass(clss.second->superId)->subclasses.push_back(clss.second);
 		}
-		this->class_hierarchy[super_name].push_back(class_name);
 	}
 
 }
 
+// Each class has exactly one super, so following super links from any class either
+// reaches Obj or goes around a cycle. This colors classes as it follows the links:
+// gray for the ones on the current path, black for the ones known to lead to Obj.
+// Running into a gray class means the path has come back on itself. Every class is
+// colored once, so the whole check is linear in the number of classes.
 bool Typechecker::classHierarchyCheck() {
-	std::stack<std::string> class_stack; // stack for the classes we've come across
-	std::vector<std::string> seen_classes; // vector for the classes we've seen to check for cycles
-	std::string current_super; // the current class we're working with / checking against
-
-	// we have to check every super class and its dependencies in its class hierarchy. if we simply
-	// start at a static class like "Obj", then we won't be able to get to classes that *don't* inherit
-	// from Obj, such as the example found in circular_dependency.qk
-	for (auto qclss : this->class_hierarchy) {
-		if (isBuiltin(qclss.first)) continue;
-
-		class_stack.push(qclss.first);
-
-		while (!class_stack.empty()) {
-			current_super = class_stack.top();
-			class_stack.pop();
-
-			// check the super class we're working with to see if it's in the vector of seen super classes,
-			// if it is then we have found a circular dependency, if not then just mark that we've seen it
-			std::vector<std::string>::iterator findCycle = std::find(seen_classes.begin(), seen_classes.end(), current_super);
-			if (findCycle != seen_classes.end()) {
-				return false;
-			}
-			seen_classes.push_back(current_super);
+	enum Color { WHITE, GRAY, BLACK };
+	std::unordered_map<Qclass*, Color> color;
+	std::vector<Qclass*> path;
 
-			// push all the dependencies of this super onto the stack so we can continue down this
-			// hierarchy
-			for (auto spr : this->class_hierarchy[current_super]) {
-				class_stack.push(spr);
-			}
+	for (auto qclss : this->classes) {
+		Qclass *current = qclss.second;
+		while (color[current] == WHITE) {
+			color[current] = GRAY;
+			path.push_back(current);
+			if (current->superId == current->id) break; // Obj
+			current = findClass(current->superId);
 		}
-
-		// clean up the stack & the seen classes, check the next hierarchy
-		while (!class_stack.empty()) {
-			class_stack.pop();
+		if (color[current] == GRAY && current->superId != current->id) {
+			return false;
+		}
+		for (Qclass *onPath : path) {
+			color[onPath] = BLACK;
 		}
-		seen_classes.clear();
+		path.clear();
 	}
 	return true;
 }
 
+// Walk the class tree down from Obj once, numbering each class on the way in and on the
+// way out. A class is a subclass of another exactly when its numbers fall inside the
+// other's, so subtype checks are two comparisons. Each class also gets its depth and
+// its ancestors at power-of-two distances, for finding common ancestors by jumping up
+// in halving steps. Like the method tables, this needs a hierarchy without cycles.
+void Typechecker::buildHierarchyIndex() {
+	Qclass *obj = findClass(SYM_OBJ);
+	int tick = 0;
+
+	// iterative, since a hierarchy can be thousands of classes deep
+	std::vector<std::pair<Qclass*, size_t>> stack;
+	obj->depth = 0;
+	obj->tourIn = tick++;
+	obj->ancestors.assign(1, obj);
+	stack.push_back(std::make_pair(obj, (size_t) 0));
+	while (!stack.empty()) {
+		Qclass *current = stack.back().first;
+		size_t next = stack.back().second++;
+		if (next == current->subclasses.size()) {
+			current->tourOut = tick++;
+			stack.pop_back();
+			continue;
+		}
+
+		Qclass *sub = current->subclasses[next];
+		sub->depth = current->depth + 1;
+		sub->tourIn = tick++;
+		sub->ancestors.assign(1, current);
+		for (size_t k = 1; ((size_t) 1 << k) <= (size_t) sub->depth; k++) {
+			sub->ancestors.push_back(sub->ancestors[k - 1]->ancestors[k - 1]);
+		}
+		stack.push_back(std::make_pair(sub, (size_t) 0));
+	}
+}
+
+// Lay out every class's method table, supers before subclasses. A class starts with
+// its super's table, puts its overrides in the slots of the methods they override,
+// and adds its new methods on the end, in the order they're defined. This has to
+// come after classHierarchyCheck, since it follows super links all the way up.
+void Typechecker::buildMethodTables() {
+	for (auto clss : this->classes) {
+		buildMethodTable(clss.second);
+	}
+}
+
+void Typechecker::buildMethodTable(Qclass *clazz) {
+	if (clazz->vtableBuilt) return;
+	clazz->vtableBuilt = true;
+
+	// Obj is its own super
+	if (clazz->superId != clazz->id) {
+		Qclass *super = findClass(clazz->superId);
+		buildMethodTable(super);
+		clazz->vtable = super->vtable;
+		clazz->slots = super->slots;
+	}
+
+	for (Qmethod *method : clazz->methods) {
+		auto inherited = clazz->slots.find(method->id);
+		if (inherited != clazz->slots.end()) {
+			method->slot = inherited->second;
+			method->overrides = clazz->vtable[method->slot];
+			clazz->vtable[method->slot] = method;
+		} else {
+			method->slot = clazz->vtable.size();
+			clazz->slots[method->id] = method->slot;
+			clazz->vtable.push_back(method);
+		}
+	}
+}
+
+// each class's signatures only depend on which classes exist, so the classes are checked in parallel
 bool Typechecker::methodSignaturesTypecheck() {
-	bool return_flag = true;
+	std::vector<Qclass*> clazzes;
 	for (auto qclss : this->classes) {
-		for(Qmethod *method : qclss.second->methods) {
-			std::string returnType = method->type["return"];
+		clazzes.push_back(qclss.second);
+	}
+	return checkEach(clazzes.size(), [&](size_t i) { return methodSignaturesTypecheck(clazzes[i]); });
+}
+
+bool Typechecker::methodSignaturesTypecheck(Qclass *clazz) {
+	bool return_flag = true;
+	for(Qmethod *method : clazz->methods) {
+		std::string returnType = method->type["return"];
+
+		// check return type exists
+		if (!doesClassExist(returnType)) {
+			RED << stageString(TYPEINFERENCE) << "method " << method->name <<
+				"() in \"" << clazz->name << "\" has non-existant return type \""
+				<< returnType << "\"" << END;
+			report::trackError(TYPEINFERENCE);
+			return_flag = false;
+		}
 
-			// check return type exists
-			if (!doesClassExist(returnType)) {
-				RED << stageString(TYPEINFERENCE) << "method " << method->name <<
-					"() in \"" << qclss.second->name << "\" has non-existant return type \""
-					<< returnType << "\"" << END;
+		// check argument types exist
+		for (std::string var : method->args) {
+			std::string varType = method->argtype[var];
+			if (!doesClassExist(varType)) {
+				RED << stageString(TYPEINFERENCE) << "overriden method " << method->name <<
+					"() in \"" << clazz->name << "\" has argument \""
+					<< var << "\" with non-existant type \"" << varType << "\"" << END;
 				report::trackError(TYPEINFERENCE);
 				return_flag = false;
-			}
-
-			// check argument types exist
-			for (std::string var : method->args) {
-				std::string varType = method->argtype[var];
-				if (!doesClassExist(varType)) {
-					RED << stageString(TYPEINFERENCE) << "overriden method " << method->name <<
-						"() in \"" << qclss.second->name << "\" has argument \""
-						<< var << "\" with non-existant type \"" << varType << "\"" << END;
-					report::trackError(TYPEINFERENCE);
-					return_flag = false;
-					continue;
-				}
+				continue;
 			}
 		}
 	}
@@ -274,61 +319,59 @@ bool Typechecker::methodsCompatibleCheck() {
 				report::trackError(CLASSHIERARCHY);
 				return_flag = false;
 			}
-			for (Qmethod *parentMethod : this->classes[qclss.second->super]->methods) {
-				if (method->name == parentMethod->name) { 
-					// we must be overriding this method if names match exactly
-					// check that types properly line up for overriden method
-
-					// check return types between overriden and parent method
-					std::string returnTypeChild = method->type["return"];
-					std::string returnTypeParent = parentMethod->type["return"];
-
-					if (!this->isSubclassOrEqual(returnTypeChild, returnTypeParent)) {
-						RED << stageString(TYPEINFERENCE) << "overriden method " << method->name <<
-							"() in \"" << qclss.second->name << "\" has return type \""
-							<< returnTypeChild << "\" inconsistent with parent method" << END;
-						report::trackError(TYPEINFERENCE);
-						return_flag = false;
-					}
+			Qmethod *parentMethod = method->overrides;
+			if (parentMethod != NULL) {
+				// we're overriding the method from the nearest super class that has it
+				// check that types properly line up for overriden method
 
-					// check that we have matching types
-					int numArgsParent = parentMethod->args.size();
-					int numArgsChild = method->args.size();
-					for (int i = 0; i < numArgsParent; i++) {
-						std::string parentArg = parentMethod->args[i];
-						std::string parentArgType = parentMethod->argtype[parentArg];
-						if (i >= numArgsChild) {
-							RED << stageString(CLASSHIERARCHY) << "overriden method " << method->name <<
-								"() in \"" << qclss.second->name << "\" is missing argument \""
-								<< parentArg << "\"" << END;
-							report::trackError(CLASSHIERARCHY);
-							return_flag = false;
-						} else {
-							std::string childArg = method->args[i];
-							std::string childArgType = method->argtype[childArg];
-							if (!isSubclassOrEqual(childArgType, parentArgType)) {
-								RED << stageString(TYPEINFERENCE) << "overriden method " << method->name <<
-									"() in \"" << qclss.second->name << "\" has argument \""
-									<< childArg << "\" with incorrect type \"" << childArgType << "\"" 
-									<< " (should be \"" << parentArgType << "\")" << END;
-								report::trackError(TYPEINFERENCE);
-								return_flag = false;
-							}
-						}
-					}
+				// check return types between overriden and parent method
+				std::string returnTypeChild = method->type["return"];
+				std::string returnTypeParent = parentMethod->type["return"];
+
+				if (!this->isSubclassOrEqual(returnTypeChild, returnTypeParent)) {
+					RED << stageString(TYPEINFERENCE) << "overriden method " << method->name <<
+						"() in \"" << qclss.second->name << "\" has return type \""
+						<< returnTypeChild << "\" inconsistent with parent method" << END;
+					report::trackError(TYPEINFERENCE);
+					return_flag = false;
+				}
 
-					// check we don't have too many args in child method
-					if (numArgsChild > numArgsParent) {
-						int difference = numArgsChild - numArgsParent;
-						for (int i = numArgsParent; i < numArgsChild; i++) {
-							RED << stageString(CLASSHIERARCHY) << "overriden method " << method->name <<
+				// check that we have matching types
+				int numArgsParent = parentMethod->args.size();
+				int numArgsChild = method->args.size();
+				for (int i = 0; i < numArgsParent; i++) {
+					std::string parentArg = parentMethod->args[i];
+					std::string parentArgType = parentMethod->argtype[parentArg];
+					if (i >= numArgsChild) {
+						RED << stageString(CLASSHIERARCHY) << "overriden method " << method->name <<
+							"() in \"" << qclss.second->name << "\" is missing argument \""
+							<< parentArg << "\"" << END;
+						report::trackError(CLASSHIERARCHY);
+						return_flag = false;
+					} else {
+						std::string childArg = method->args[i];
+						std::string childArgType = method->argtype[childArg];
+						if (!isSubclassOrEqual(childArgType, parentArgType)) {
+							RED << stageString(TYPEINFERENCE) << "overriden method " << method->name <<
 								"() in \"" << qclss.second->name << "\" has argument \""
-								<< method->args[i] << "\" not present in parent method" << END;
-							report::trackError(CLASSHIERARCHY);
+								<< childArg << "\" with incorrect type \"" << childArgType << "\"" 
+								<< " (should be \"" << parentArgType << "\")" << END;
+							report::trackError(TYPEINFERENCE);
 							return_flag = false;
 						}
 					}
+				}
 
+				// check we don't have too many args in child method
+				if (numArgsChild > numArgsParent) {
+					int difference = numArgsChild - numArgsParent;
+					for (int i = numArgsParent; i < numArgsChild; i++) {
+						RED << stageString(CLASSHIERARCHY) << "overriden method " << method->name <<
+							"() in \"" << qclss.second->name << "\" has argument \""
+							<< method->args[i] << "\" not present in parent method" << END;
+						report::trackError(CLASSHIERARCHY);
+						return_flag = false;
+					}
 				}
 			}
 		}
@@ -336,71 +379,125 @@ bool Typechecker::methodsCompatibleCheck() {
 	return return_flag;
 }
 
-bool Typechecker::initCheckStmt(Qmethod *method, AST::Node *stmt, 
-							std::vector<std::string> &var_init,
-                            std::vector<std::string> &field_init,
-                            bool isConstructor, bool isMainStatements) {
+InitState::InitState(Qmethod *method, bool isConstructor) : cfg(method->stmts) {
+	locals = &method->locals;
+	fieldSlots = isConstructor ? &method->clazz->fieldSlots : NULL;
+	vars = solveDataflow(cfg, initializedVariables(cfg, method->locals, method->init));
+	if (isConstructor) {
+		fields = solveDataflow(cfg, initializedFields(cfg, method->clazz->fieldSlots, method->clazz->fields));
+	}
+}
+
+void InitState::enter(AST::Node *stmt) {
+	BasicBlock *next = cfg.blockOf(stmt);
+	if (next == NULL || next == block) return;
+	block = next;
+	if (cfg.isReachable(block)) {
+		varsNow = vars.in[block->id];
+		if (fieldSlots != NULL) fieldsNow = fields.in[block->id];
+	}
+}
+
+void InitState::leave(AST::Node *stmt) {
+	BasicBlock *join = cfg.joinOf(stmt);
+	if (join != NULL) {
+		if (cfg.isReachable(join)) {
+			block = join;
+			varsNow = vars.in[join->id];
+			if (fieldSlots != NULL) fieldsNow = fields.in[join->id];
+		}
+		return;
+	}
+
+	Symbol var = assignedVariable(stmt);
+	if (var != NO_SYMBOL) varsNow.insert(locals->slotFor(var));
+	Symbol field = assignedField(stmt);
+	if (field != NO_SYMBOL && fieldSlots != NULL) fieldsNow.insert(fieldSlots->slotFor(field));
+}
+
+int InitState::unevenField(AST::Node *stmt) const {
+	BasicBlock *join = cfg.joinOf(stmt);
+	SlotSet everyPath = SlotSet::all(fieldSlots->size());
+	for (BasicBlock *pred : join->preds) {
+		if (cfg.isReachable(pred)) everyPath &= fields.out[pred->id];
+	}
+	for (BasicBlock *pred : join->preds) {
+		if (!cfg.isReachable(pred)) continue;
+		int slot = fields.out[pred->id].firstNotIn(everyPath);
+		if (slot >= 0) return slot;
+	}
+	return -1;
+}
+
+bool Typechecker::initCheckStmts(Qmethod *method, const AST::NodeList &stmts, InitState &state,
+							bool isConstructor, bool isMainStatements) {
+	bool ret_flag = true;
+	for (AST::Node *stmt : stmts) {
+		state.enter(stmt);
+		if (!initCheckStmt(method, stmt, state, isConstructor, isMainStatements)) ret_flag = false;
+		state.leave(stmt);
+	}
+	return ret_flag;
+}
+
+bool Typechecker::initCheckStmt(Qmethod *method, AST::Node *stmt, InitState &state,
+							bool isConstructor, bool isMainStatements) {
 	bool ret_flag = true;
 	Type nodeType = stmt->type;
+	// the field a constructor's "this.x = ..." assigns isn't read, so the walk over the children skips it
+	AST::Node *assigned = NULL;
 
 	if (nodeType == TYPECASE) {
 		// check that the cond is init first (no type checking yet, it can be anything)
 		AST::Node *var = stmt->rawChildren[0];
 		if (var != NULL) {
-			if (!initCheckStmt(method, var, var_init, field_init, isConstructor, isMainStatements)) ret_flag = false;
+			state.enter(var);
+			if (!initCheckStmt(method, var, state, isConstructor, isMainStatements)) ret_flag = false;
 		}
+		SlotSet before = state.varsNow;
 
 		AST::Node *type_alts_container = stmt->get(TYPE_ALTERNATIVES);
-		std::vector<AST::Node *> type_alts = type_alts_container->getAll(TYPE_ALTERNATIVE);
-
-		std::vector<std::string> var_init_copy1 = var_init;
-		std::vector<std::string> field_init_copy1 = field_init;
+		AST::ChildRange type_alts = type_alts_container->getAll(TYPE_ALTERNATIVE);
 
 		for (AST::Node *type_alt : type_alts) {
 			AST::Node *ident = type_alt->getBySubtype(VAR_IDENT);
 			// if the newly introduced variable is already in init, throw an error
-			if (isVarInit(method, ident->name)) {
+			if (before.test(method->locals.find(ident->symbol))) {
 				RED << stageString(INITBEFOREUSE) << "typecase cannot re-introduce variable \"" 
-					<< ident->name << "\" in method " << method->name << "() in class \""
+					<< ident->name() << "\" in method " << method->name << "() in class \""
 					<< method->clazz->name << "\"" << END;
 					report::trackError(INITBEFOREUSE);
 				ret_flag = false;
-			} else { // else iterate through all the statements
-				var_init_copy1.push_back(ident->name); // we need to push the newly introduced var onto the temporary vector
+			} else { // else iterate through all the statements, with the new variable initialized
+				state.enter(type_alt);
+				state.leave(type_alt);
 				AST::Node *type_stmts = type_alt->get(BLOCK, STATEMENTS);
-				for (AST::Node *type_stmt : type_stmts->rawChildren) {
-					if (!initCheckStmt(method, type_stmt, var_init_copy1, field_init_copy1, isConstructor, isMainStatements)) ret_flag = false;
-				}
+				if (!initCheckStmts(method, type_stmts->rawChildren, state, isConstructor, isMainStatements)) ret_flag = false;
 			}
 		}
 
 		if (isConstructor) {
-			std::vector<std::string> uninitializedFields;
-			uninitializedFields = difference(field_init, field_init_copy1);
-			for (std::string f : uninitializedFields) {
-				RED << stageString(INITBEFOREUSE) << "instance variable \"" << f 
+			int uninitializedField = state.unevenField(stmt);
+			if (uninitializedField >= 0) {
+				RED << stageString(INITBEFOREUSE) << "instance variable \"" << symbols.name(method->clazz->fieldSlots.name(uninitializedField))
 					<< "\" not initialized on all syntactic paths in \"" << method->clazz->name << "\"" << END;
 					report::trackError(INITBEFOREUSE);
 					ret_flag = false;
 				return ret_flag;
 			}
 		}
-
-		// update final return vectors
-		var_init = intersection(var_init, var_init_copy1);
-		field_init = intersection(field_init, field_init_copy1);
 		return ret_flag;
 	} 
 	else if (nodeType == CALL) {
 		AST::Node *actual_args_container = stmt->get(ACTUAL_ARGS);
 		if (actual_args_container != NULL) {
-			std::vector<AST::Node *> actual_args = actual_args_container->getAll(METHOD_ARG);
+			AST::ChildRange actual_args = actual_args_container->getAll(METHOD_ARG);
 			if (!actual_args.empty()) {
 				for (AST::Node *arg : actual_args) {
 					AST::Node *real_arg = arg->getBySubtype(METHOD_ARG); // the actual arg node is inside of the "METHOD_ARG" node
 					if (real_arg->type == LOAD) {
 						if (real_arg->get(IDENT) != NULL) {
-							if (real_arg->get(IDENT)->name == "this") {
+							if (real_arg->get(IDENT)->name() == "this") {
 								if (isConstructor) {
 									RED << stageString(INITBEFOREUSE) << "attempt to use \"this\" before full initialization in constructor of \"" 
 										<< method->clazz->name << "\"" << END;
@@ -415,37 +512,31 @@ bool Typechecker::initCheckStmt(Qmethod *method, AST::Node *stmt,
 			}
 		}
 	}
-	// control flow has the most complicated case, have to check all syntactic paths
+	// control flow has the most complicated case, have to check all syntactic paths.
+	// the control flow graph has worked out what's initialized where already, so the
+	// walk just has to check the statements in order
 	// init check while loop
 	else if (nodeType == WHILE) {
 		// check that the cond is init first (no type checking yet, it can be anything)
 		AST::Node *cond = stmt->get(COND);
 		if (cond != NULL) {
-			if (!initCheckStmt(method, cond, var_init, field_init, isConstructor, isMainStatements)) ret_flag = false;
+			state.enter(cond);
+			if (!initCheckStmt(method, cond, state, isConstructor, isMainStatements)) ret_flag = false;
 		}
 
 		AST::Node *while_stmts = stmt->get(BLOCK, STATEMENTS);
-		std::vector<std::string> var_init_copy1 = var_init;
-		std::vector<std::string> field_init_copy1 = field_init;
-		for (AST::Node *n : while_stmts->rawChildren) {
-			if (!initCheckStmt(method, n, var_init_copy1, field_init_copy1, isConstructor, isMainStatements)) ret_flag = false;
-		}
+		if (!initCheckStmts(method, while_stmts->rawChildren, state, isConstructor, isMainStatements)) ret_flag = false;
 
 		if (isConstructor) {
-			std::vector<std::string> uninitializedFields;
-			uninitializedFields = difference(field_init, field_init_copy1);
-			for (std::string f : uninitializedFields) {
-				RED << stageString(INITBEFOREUSE) << "instance variable \"" << f 
+			int uninitializedField = state.unevenField(stmt);
+			if (uninitializedField >= 0) {
+				RED << stageString(INITBEFOREUSE) << "instance variable \"" << symbols.name(method->clazz->fieldSlots.name(uninitializedField))
 					<< "\" not initialized on all syntactic paths in \"" << method->clazz->name << "\"" << END;
 					report::trackError(INITBEFOREUSE);
 					ret_flag = false;
 				return ret_flag;
 			}
 		}
-
-		// update final return vectors
-		var_init = intersection(var_init, var_init_copy1);
-		field_init = intersection(field_init, field_init_copy1);
 		return ret_flag;
 	}
 	// init check if statements
@@ -453,41 +544,29 @@ bool Typechecker::initCheckStmt(Qmethod *method, AST::Node *stmt,
 		// check that the cond is init first (no type checking yet, it can be anything)
 		AST::Node *cond = stmt->get(COND);
 		if (cond != NULL) {
-			if (!initCheckStmt(method, cond, var_init, field_init, isConstructor, isMainStatements)) ret_flag = false;
+			state.enter(cond);
+			if (!initCheckStmt(method, cond, state, isConstructor, isMainStatements)) ret_flag = false;
 		}
 
 		AST::Node *true_stmts = stmt->get(BLOCK, TRUE_STATEMENTS);
-		std::vector<std::string> var_init_copy1 = var_init;
-		std::vector<std::string> field_init_copy1 = field_init;
-		for (AST::Node *n : true_stmts->rawChildren) {
-			if (!initCheckStmt(method, n, var_init_copy1, field_init_copy1, isConstructor, isMainStatements)) ret_flag = false;
-		}
+		if (!initCheckStmts(method, true_stmts->rawChildren, state, isConstructor, isMainStatements)) ret_flag = false;
 
 		AST::Node *false_stmts = stmt->get(BLOCK, FALSE_STATEMENTS);
-		std::vector<std::string> var_init_copy2 = var_init;
-		std::vector<std::string> field_init_copy2 = field_init;
-		for (AST::Node *n : false_stmts->rawChildren) {
-			if (!initCheckStmt(method, n, var_init_copy2, field_init_copy2, isConstructor, isMainStatements)) ret_flag = false;
-		}
+		if (!initCheckStmts(method, false_stmts->rawChildren, state, isConstructor, isMainStatements)) ret_flag = false;
 
 		// if we're in the constructor, we need to make sure all fields are initialized on all paths
 		// if we aren't in the constructor, we don't have to assign on all paths (but will still throw
 		// an error later on if we attempt to assign to an unknown field)
 		if (isConstructor) {
-			std::vector<std::string> uninitializedFields;
-			uninitializedFields = difference(field_init_copy1, field_init_copy2);
-			for (std::string f : uninitializedFields) {
-				RED << stageString(INITBEFOREUSE) << "instance variable \"" << f 
+			int uninitializedField = state.unevenField(stmt);
+			if (uninitializedField >= 0) {
+				RED << stageString(INITBEFOREUSE) << "instance variable \"" << symbols.name(method->clazz->fieldSlots.name(uninitializedField))
 					<< "\" not initialized on all syntactic paths in \"" << method->clazz->name << "\"" << END;
 					report::trackError(INITBEFOREUSE);
 					ret_flag = false;
 				return ret_flag;
 			}
 		}
-
-		// update our final return vectors
-		var_init = intersection(var_init_copy1, var_init_copy2);
-		field_init = intersection(field_init_copy1, field_init_copy2);
 		return ret_flag;
 	}
 	// matches all types of assign nodes ("something = something")
@@ -496,7 +575,7 @@ bool Typechecker::initCheckStmt(Qmethod *method, AST::Node *stmt,
 		if (r_expr != NULL) {
 			AST::Node *ident = r_expr->get(IDENT);
 			if (ident != NULL) {
-				if (ident->name == "this" && isConstructor) {
+				if (ident->name() == "this" && isConstructor) {
 					RED << stageString(INITBEFOREUSE) << "attempt to pass or assign a variable to \"this\" in constructor of class "
 					<< method->clazz->name << END;
 					report::trackError(INITBEFOREUSE);
@@ -511,14 +590,15 @@ bool Typechecker::initCheckStmt(Qmethod *method, AST::Node *stmt,
 		if (left != NULL) {
 			AST::Node *load = left->get(LOAD);
 			if (load != NULL) {
-				if (load->get(IDENT)->name == "this") { 
+				if (load->get(IDENT)->name() == "this") { 
 					if (isMainStatements) {
 						RED << stageString(INITBEFOREUSE) << "reference to \"this\" found in program's main statements" << END;
 						report::trackError(INITBEFOREUSE);
 						ret_flag = false;
 						return ret_flag;
 					}
-					std::string instanceVar = left->get(IDENT)->name;
+					std::string instanceVar = left->get(IDENT)->name();
+					Symbol instanceVarId = left->get(IDENT)->symbol;
 
 					if (instanceVar == "this") {
 						RED << stageString(INITBEFOREUSE) << "invalid assignment of form this.this found in \"" 
@@ -528,7 +608,7 @@ bool Typechecker::initCheckStmt(Qmethod *method, AST::Node *stmt,
 						ret_flag = false;
 					} 
 
-					if (isConstructor) { // we have found a this.x = ... statement, push back to class's instancevars
+					if (isConstructor) { // we have found a this.x = ... statement, which makes x a field
 						if (doesClassExist(instanceVar)) {
 							RED << stageString(INITBEFOREUSE) << "instance variable \""
 								<< instanceVar << "\" in class \""
@@ -545,14 +625,9 @@ bool Typechecker::initCheckStmt(Qmethod *method, AST::Node *stmt,
 								ret_flag = false;
 							}
 						}
-
-						// if it isn't in the vector already, push it in
-						if (!isInstanceVar(method, instanceVar) && (std::find(field_init.begin(), field_init.end(), instanceVar) == field_init.end()) ) {
-							field_init.push_back(instanceVar);
-						}
-				 		
+						assigned = left;
 					} else {
-						if (!isInstanceVar(method, instanceVar) && (std::find(field_init.begin(), field_init.end(), instanceVar) == field_init.end()) ) {
+						if (!isInstanceVar(method, instanceVarId)) {
 							RED << stageString(INITBEFOREUSE) << "attempt to assign to non-existant instance variable \""
 								<< instanceVar << "\" in \"" << method->name << "\" in class \""
 								<< method->clazz->name << "\"" << END;
@@ -568,20 +643,12 @@ bool Typechecker::initCheckStmt(Qmethod *method, AST::Node *stmt,
 		left = stmt->get(IDENT, LOC);
 		if (left != NULL) {
 			// check if we are assigning to an illegal value (boolean identifier)
-			bool is_invalid = false;
-			if (left->name == "false" || left->name == "true" || left->name == "this") {
+			if (left->name() == "false" || left->name() == "true" || left->name() == "this") {
 				RED << stageString(TYPEINFERENCE) << "attempt to assign to invalid value \""
-					<< left->name << "\" in \"" << method->name << "\" in class \""
+					<< left->name() << "\" in \"" << method->name << "\" in class \""
 					<< method->clazz->name << "\"" << END;
 				report::trackError(TYPEINFERENCE);
 				ret_flag = false;
-				is_invalid = true;
-			}
-
-			if (!is_invalid) {
-				if (!isVarInit(method, left->name) && (std::find(var_init.begin(), var_init.end(), left->name) == var_init.end()) ) {
-					var_init.push_back(left->name);
-				}
 			}
 		}
 	}
@@ -591,7 +658,7 @@ bool Typechecker::initCheckStmt(Qmethod *method, AST::Node *stmt,
 		if (load != NULL) {
 			if (load->get(IDENT) != NULL) {
 				// we have a "this.x" somewhere in a method, make appropriate checks
-				if (load->get(IDENT)->name == "this") {
+				if (load->get(IDENT)->name() == "this") {
 					if (isMainStatements) {
 							RED << stageString(INITBEFOREUSE) << "reference to \"this\" found in program's main statements" << END;
 							report::trackError(INITBEFOREUSE);
@@ -599,8 +666,9 @@ bool Typechecker::initCheckStmt(Qmethod *method, AST::Node *stmt,
 							return ret_flag;
 					}
 
-					std::string instanceVar = stmt->get(IDENT)->name;
-					if (!isInstanceVar(method, instanceVar) && (std::find(field_init.begin(), field_init.end(), instanceVar) == field_init.end()) ) {
+					std::string instanceVar = stmt->get(IDENT)->name();
+					Symbol instanceVarId = stmt->get(IDENT)->symbol;
+					if (!isInstanceVar(method, instanceVarId) && !state.fieldsNow.test(method->clazz->fieldSlots.find(instanceVarId))) {
 						RED << stageString(INITBEFOREUSE) << "uninitialized instance variable \"this."
 							<< instanceVar << "\" used in method " << method->name << "() in class \""
 							<< method->clazz->name << "\"" << END;
@@ -615,7 +683,7 @@ bool Typechecker::initCheckStmt(Qmethod *method, AST::Node *stmt,
 	else if (nodeType == LOAD) {
 		// if we find a "this" on its own
 		if (stmt->get(IDENT) != NULL) { 
-			if (stmt->get(IDENT)->name == "this") {
+			if (stmt->get(IDENT)->name() == "this") {
 				if (isMainStatements) {
 					RED << stageString(INITBEFOREUSE) << "reference to \"this\" found in program's main statements" << END;
 					report::trackError(INITBEFOREUSE);
@@ -624,11 +692,12 @@ bool Typechecker::initCheckStmt(Qmethod *method, AST::Node *stmt,
 				}
 			} else {
 				// if its a boolean, we dont need to check if its init
-				std::string ident = stmt->get(IDENT)->name;
+				std::string ident = stmt->get(IDENT)->name();
 				if (ident != "false" && ident != "true" && ident != "none") {
-					if (!isVarInit(method, ident) && (std::find(var_init.begin(), var_init.end(), ident) == var_init.end()) )  {
+					Symbol identId = stmt->get(IDENT)->symbol;
+					if (!state.varsNow.test(method->locals.find(identId)))  {
 						RED << stageString(INITBEFOREUSE) << "uninitialized variable \""
-							<< stmt->get(IDENT)->name << "\" used in " << method->name << "() in class \""
+							<< stmt->get(IDENT)->name() << "\" used in " << method->name << "() in class \""
 							<< method->clazz->name << "\"" << END;
 						report::trackError(INITBEFOREUSE);
 						ret_flag = false;
@@ -651,7 +720,8 @@ bool Typechecker::initCheckStmt(Qmethod *method, AST::Node *stmt,
 	}
 
 	for (AST::Node *child : stmt->rawChildren) {
-		if (!initCheckStmt(method, child, var_init, field_init, isConstructor, isMainStatements)) ret_flag = false;
+		if (child == assigned) continue;
+		if (!initCheckStmt(method, child, state, isConstructor, isMainStatements)) ret_flag = false;
 	}
 
 	return ret_flag;
@@ -661,12 +731,14 @@ bool Typechecker::initCheckQmethod(Qmethod *method, bool isConstructor, bool isM
 	bool ret_flag = true;
 	if (method->stmts.empty()) return ret_flag;
 
-	// we pass this vector around so we know what we initialized after each statement
-	std::vector<std::string> var_init;
-	std::vector<std::string> field_init;
+	// what's initialized where, worked out over the method's control flow graph up front
+	InitState state(method, isConstructor);
 
 	for (AST::Node* stmt : method->stmts) {
+		state.enter(stmt);
+
 		// do some preliminary checks before handing it off to the recursive method
+		AST::Node *ident = (stmt->type == LOAD) ? stmt->get(IDENT, LOC) : NULL;
 		if (stmt->type == CONSTRUCTOR) {
 			// if you found a constructor "Class(x, y, z);" on its own, that is an error (maybe should be a warning?)
 			RED << stageString(INITBEFOREUSE) << "constructor not assigned to any variable or called in method \""
@@ -674,60 +746,86 @@ bool Typechecker::initCheckQmethod(Qmethod *method, bool isConstructor, bool isM
 				<< method->clazz->name << "\"" << END;
 			report::trackError(INITBEFOREUSE);
 			ret_flag = false;
-			continue;
-		} else if (stmt->type == LOAD) {
+		} else if (ident != NULL && !state.varsNow.test(method->locals.find(ident->symbol))) {
 			// if you have a statement that is just "x;" you should throw an error if it isn't initialized
-			AST::Node *ident = stmt->get(IDENT, LOC);
-			if (ident != NULL) {
-				if (!isVarInit(method, ident->name)) {
-					RED << stageString(INITBEFOREUSE) << "attempt to load uninitialized variable \""
-					<< ident->name << "\" in method \"" << method->name << "\" in class \""
-					<< method->clazz->name << "\"" << END;
-					report::trackError(INITBEFOREUSE);
-					ret_flag = false;
-					continue;
-				}
-			}
+			RED << stageString(INITBEFOREUSE) << "attempt to load uninitialized variable \""
+			<< ident->name() << "\" in method \"" << method->name << "\" in class \""
+			<< method->clazz->name << "\"" << END;
+			report::trackError(INITBEFOREUSE);
+			ret_flag = false;
+		} else {
+			if(!initCheckStmt(method, stmt, state, isConstructor, isMainStatements)) ret_flag = false;
 		}
+		state.leave(stmt);
 
-		if(!initCheckStmt(method, stmt, var_init, field_init, isConstructor, isMainStatements)) ret_flag = false;
-
-		// for each thing in passed around vector, add to init/instancevars, then clear the vectors/maps
-		for (std::string var : var_init) {
-			method->init.push_back(var);
-			method->type[var] = "$UNKNOWN";
+		// whatever is newly initialized for good after each statement goes into init/instancevars
+		for (int slot : state.varsNow.slots()) {
+			if (method->init.test(slot)) continue;
+			method->init.insert(slot);
+			method->type[symbols.name(method->locals.name(slot))] = "$UNKNOWN";
 		}
-		for (std::string field : field_init) {
-			method->clazz->instanceVars.push_back(field);
-			method->clazz->instanceVarType[field] = "$UNKNOWN";
+		if (isConstructor) {
+			for (int slot : state.fieldsNow.slots()) {
+				if (method->clazz->fields.test(slot)) continue;
+				Symbol field = method->clazz->fieldSlots.name(slot);
+				addInstanceVar(method->clazz, field);
+				method->clazz->instanceVarType[symbols.name(field)] = "$UNKNOWN";
+			}
 		}
-		var_init.clear();
-		field_init.clear();
 	}
 
 	return ret_flag;
 }
 
-bool Typechecker::initializeBeforeUseCheck() {
+// the constructor first, since it decides what the instance variables are
+bool Typechecker::initCheckQclass(Qclass *clazz) {
 	bool ret_flag = true;
+	if (!initCheckQmethod(clazz->constructor, true, false)) ret_flag = false;
+	for (Qmethod *m : clazz->methods) {
+		if(!initCheckQmethod(m, false, false)) ret_flag = false;
+	}
+	return ret_flag;
+}
 
+bool Typechecker::initializeBeforeUseCheck() {
 	// init before use check constructor, then init check methods
-	// we don't need to do all constructors first here, but we do in type checking
+	// we don't need to do all constructors first here, but we do in type checking.
+	// a class's check only touches that class, so the classes are checked in parallel
+	std::vector<Qclass*> clazzes;
 	for (auto clss : this->classes) {
 		if (isBuiltin(clss.second->name)) { 
 			continue;
 		}
-		if (!initCheckQmethod(clss.second->constructor, true, false)) ret_flag = false;
-		for (Qmethod *m : clss.second->methods) {
-			if(!initCheckQmethod(m, false, false)) ret_flag = false;
-		}
+		clazzes.push_back(clss.second);
 	}
 
 	// init check the main statements
 	if (this->main != NULL) {
-		if (!initCheckQmethod(this->main->constructor, false, true)) ret_flag = false;
+		clazzes.push_back(this->main);
 	}
 
+	return checkEach(clazzes.size(), [&](size_t i) {
+		if (clazzes[i] == this->main) {
+			return initCheckQmethod(this->main->constructor, false, true);
+		}
+		return initCheckQclass(clazzes[i]);
+	});
+}
+
+bool Typechecker::checkEach(size_t count, const std::function<bool(size_t)> &check) {
+	std::vector<report::Diagnostics> diagnostics(count);
+	std::vector<char> passed(count, true);
+	pool.forEach(count, [&](size_t i) {
+		report::collect(&diagnostics[i]);
+		passed[i] = check(i);
+		report::collect(NULL);
+	});
+
+	bool ret_flag = true;
+	for (size_t i = 0; i < count; i++) {
+		diagnostics[i].replay();
+		if (!passed[i]) ret_flag = false;
+	}
 	return ret_flag;
 }
 
@@ -737,31 +835,56 @@ bool Typechecker::initializeBeforeUseCheck() {
 // The result of the type inference is set through "ret_flag", this time through a passed reference
 // rather than return value (so we can reserve the return value for the previously mentioned reason).
 // When a type is inferred for a variable, it is set as a side effect rather than returned.
+// Every node inferred is annotated with its type, and since inference runs until nothing
+// changes, the annotation left behind by the last pass is the node's final static type.
 std::string Typechecker::typeInferStmt(Qmethod *method, AST::Node *stmt, bool &changed, bool &ret_flag) {
+	std::string inferred = typeInferNode(method, stmt, changed, ret_flag);
+	if (stmt->staticType == NO_SYMBOL || symbols.name(stmt->staticType) != inferred) {
+		stmt->staticType = symbols.intern(inferred);
+	}
+	return inferred;
+}
+
+std::string Typechecker::typeInferNode(Qmethod *method, AST::Node *stmt, bool &changed, bool &ret_flag) {
 	Type nodeType = stmt->type;
 
 	if (nodeType == TYPECASE) {
+		// the value being switched on, so its type is there for codegen
+		typeInferStmt(method, stmt->get(LOAD), changed, ret_flag);
+
 		AST::Node *type_alts_container = stmt->get(TYPE_ALTERNATIVES);
-		std::vector<AST::Node *> type_alts = type_alts_container->getAll(TYPE_ALTERNATIVE);
+		AST::ChildRange type_alts = type_alts_container->getAll(TYPE_ALTERNATIVE);
 
 		for (AST::Node *type_alt : type_alts) {
 			AST::Node *ident = type_alt->getBySubtype(VAR_IDENT);
 			AST::Node *ident_type = type_alt->getBySubtype(TYPE_IDENT);
 			// if the newly introduced variable is already in init, throw an error
-			if (!doesClassExist(ident_type->name)) {
+			if (!doesClassExist(ident_type->name())) {
 				RED << stageString(INITBEFOREUSE) << "typecase introduces variable \"" 
-					<< ident->name << "\" with unknown type \"" << ident_type->name
+					<< ident->name() << "\" with unknown type \"" << ident_type->name()
 					<< "\" in method " << method->name << "() in class \""
 					<< method->clazz->name << "\"" << END;
 					report::trackError(INITBEFOREUSE);
 				ret_flag = false;
 				stmt->skip = true;
 			} else { // else iterate through all the statements
-				method->type[ident->name] = ident_type->name;
+				method->type[ident->name()] = ident_type->name();
 				AST::Node *type_stmts = type_alt->get(BLOCK, STATEMENTS);
 				for (AST::Node *type_stmt : type_stmts->rawChildren) {
 					typeInferStmt(method, type_stmt, changed, ret_flag);
 				}
+
+				// the alternative's statements were checked with the variable as the matched type,
+				// so giving it some other type in there would make those checks wrong
+				if (method->type[ident->name()] != ident_type->name() && !type_alt->skip) {
+					RED << stageString(TYPEINFERENCE) << "typecase variable \""
+						<< ident->name() << "\" of type \"" << ident_type->name() << "\" is given type \""
+						<< method->type[ident->name()] << "\" in method " << method->name << "() in class \""
+						<< method->clazz->name << "\"" << END;
+					report::trackError(TYPEINFERENCE);
+					ret_flag = false;
+					type_alt->skip = true;
+				}
 			}
 		}
 	}
@@ -783,7 +906,11 @@ std::string Typechecker::typeInferStmt(Qmethod *method, AST::Node *stmt, bool &c
 		}
 
 		if (new_type != curr_type) {
-			method->type["return"] = leastCommonAncestor(curr_type, new_type);
+			std::string widened = leastCommonAncestor(curr_type, new_type);
+			if (widened != curr_type) {
+				method->type["return"] = widened;
+				enqueueInference(method->callers);
+			}
 		}
 	}
 	else if (nodeType == IF) {
@@ -835,12 +962,10 @@ std::string Typechecker::typeInferStmt(Qmethod *method, AST::Node *stmt, bool &c
 		// if (stmt->skip) return lhsType; // we dont want to error check again
 		AST::Node *lhs = stmt->rawChildren[0]; // left hand side can be any type of node
 		std::string lhsType = typeInferStmt(method, lhs, changed, ret_flag);
-		std::string methodName = stmt->rawChildren[1]->name; // center node is always the ident corresponding to method name
+		std::string methodName = stmt->rawChildren[1]->name(); // center node is always the ident corresponding to method name
 
-		Qclass *qclass;
-		Qclass *qclass_temp;
 		Qmethod *calledMethod;
-		if (doesClassExist(lhsType)) {
+		if (findClass(lhs->staticType) != NULL) {
 			if (methodName == "NEGATE") {
 				if (lhsType != "Int") {
 					RED << stageString(TYPEINFERENCE) << "invalid use of \"negate\" operator on non-integer object \""
@@ -879,7 +1004,7 @@ std::string Typechecker::typeInferStmt(Qmethod *method, AST::Node *stmt, bool &c
 				} else {
 					AST::Node *actual_args_container = stmt->get(ACTUAL_ARGS);
 					if (actual_args_container != NULL) {
-						std::vector<AST::Node *> actual_args = actual_args_container->getAll(METHOD_ARG);
+						AST::ChildRange actual_args = actual_args_container->getAll(METHOD_ARG);
 						if (actual_args.size() == 1) {
 							AST::Node *real_arg = actual_args.front()->getBySubtype(METHOD_ARG);
 							std::string argType = typeInferStmt(method, real_arg, changed, ret_flag);
@@ -908,30 +1033,10 @@ std::string Typechecker::typeInferStmt(Qmethod *method, AST::Node *stmt, bool &c
 			}
 
 
-			bool foundMethod = false;
-			qclass = this->classes[lhsType];
-			qclass_temp = qclass;
-			find: // keep jumping to this label if we haven't seen the method yet
-				//OUT << "current class we're iterating over is " << qclass_temp->name << END;
-				for (Qmethod *m : qclass_temp->methods) {
-					//OUT << "	mname is " << m->name << END;
-					if (m->name == methodName) {
-						foundMethod = true;
-						calledMethod = m;
-						break;
-					}
-				}
-
-			if (!foundMethod) { // if we haven't seen the method yet, iterate through the supers
-				if (qclass_temp->name != "Obj") { // we're at the top of the tree, stop looking
-					qclass_temp = this->classes[qclass_temp->super];
-					goto find;
-				}
-			}
+			// the method table already has whatever the class inherits
+			calledMethod = resolveMethod(findClass(lhs->staticType), stmt->rawChildren[1]->symbol);
 
-			//OUT << END;
-
-			if (!foundMethod) {
+			if (calledMethod == NULL) {
 				RED << stageString(TYPEINFERENCE) << "method " << methodName << "() not found in class \""
 					<< lhsType << "\" in method \"" << method->name << "\" in class \""
 					<< method->clazz->name << "\"" << END;
@@ -951,13 +1056,14 @@ std::string Typechecker::typeInferStmt(Qmethod *method, AST::Node *stmt, bool &c
 			return lhsType;
 		}
 
+		calledMethod->callers.insert(method);
 		std::string returnType = calledMethod->type["return"];
 		// if we're here, we know the method exists. now we compare args
 		int numArgsMethod = calledMethod->args.size();
 		// make sure all our args line up
 		AST::Node *actual_args_container = stmt->get(ACTUAL_ARGS);
 		if (actual_args_container != NULL) {
-			std::vector<AST::Node *> actual_args = actual_args_container->getAll(METHOD_ARG);
+			AST::ChildRange actual_args = actual_args_container->getAll(METHOD_ARG);
 			if (!actual_args.empty()) {
 				std::vector<std::string> argTypes;
 				for (AST::Node *arg : actual_args) {
@@ -1030,7 +1136,7 @@ std::string Typechecker::typeInferStmt(Qmethod *method, AST::Node *stmt, bool &c
 	else if (nodeType == CONSTRUCTOR) {
 		AST::Node *class_name_node = stmt->get(IDENT);
 		if (class_name_node != NULL) {
-			std::string class_name = class_name_node->name;
+			std::string class_name = class_name_node->name();
 			if (doesClassExist(class_name)) {
 				if (stmt->skip) return class_name; // we dont want to error check again
 				Qclass *qclass = this->classes[class_name];
@@ -1040,7 +1146,7 @@ std::string Typechecker::typeInferStmt(Qmethod *method, AST::Node *stmt, bool &c
 				// make sure all our args line up
 				AST::Node *actual_args_container = stmt->get(ACTUAL_ARGS);
 				if (actual_args_container != NULL) {
-					std::vector<AST::Node *> actual_args = actual_args_container->getAll(METHOD_ARG);
+					AST::ChildRange actual_args = actual_args_container->getAll(METHOD_ARG);
 					if (!actual_args.empty()) {
 						std::vector<std::string> argTypes;
 						for (AST::Node *arg : actual_args) {
@@ -1127,36 +1233,38 @@ std::string Typechecker::typeInferStmt(Qmethod *method, AST::Node *stmt, bool &c
 		if (left != NULL) {
 			AST::Node *load = left->get(LOAD);
 			if (load != NULL) {
-				if (load->get(IDENT)->name == "this") { // we have found a this.x = ... statement
-					std::string instanceVar = left->get(IDENT)->name;
+				if (load->get(IDENT)->name() == "this") { // we have found a this.x = ... statement
+					std::string instanceVar = left->get(IDENT)->name();
 					if (stmt->skip) return method->clazz->instanceVarType[instanceVar];
+					method->clazz->fieldReaders[instanceVar].insert(method);
 
 					// if it has an explicit type
 					AST::Node *explicit_type = stmt->get(IDENT, TYPE_IDENT);
 					if (explicit_type != NULL) {
-						if (!doesClassExist(explicit_type->name)) {
+						if (!doesClassExist(explicit_type->name())) {
 							RED << stageString(TYPEINFERENCE) << "attempt to assign explicit type with unknown class \""  
-								<< explicit_type->name << "\" in method " << method->name << "() in class \"" 
+								<< explicit_type->name() << "\" in method " << method->name << "() in class \"" 
 								<< method->clazz->name << "\"" << END;
 							report::trackError(TYPEINFERENCE);
 							ret_flag = false;
 							stmt->skip = true;
 							return method->clazz->instanceVarType[instanceVar];
 						}
-						if (isSubclassOrEqual(method->clazz->instanceVarType[instanceVar], explicit_type->name)) {
-							method->clazz->instanceVarType[instanceVar] = explicit_type->name;
+						if (isSubclassOrEqual(method->clazz->instanceVarType[instanceVar], explicit_type->name())) {
+							if (method->clazz->instanceVarType[instanceVar] != explicit_type->name()) {
+								method->clazz->instanceVarType[instanceVar] = explicit_type->name();
+								enqueueInference(method->clazz->fieldReaders[instanceVar]);
+							}
 						} else {
 							RED << stageString(TYPEINFERENCE) << "instance variable \""
 								<< instanceVar << "\" in class \""
-								<< method->clazz->name << "\" is assigned invalid explicit type \"" << explicit_type->name << "\"" << END;
+								<< method->clazz->name << "\" is assigned invalid explicit type \"" << explicit_type->name() << "\"" << END;
 							report::trackError(TYPEINFERENCE);
 							ret_flag = false;
 							stmt->skip = true;
 							return method->clazz->instanceVarType[instanceVar];
 						}
-						if (!isInstanceVarExplicit(method, instanceVar)) {
-							method->clazz->explicitFields.push_back(instanceVar);
-						}
+						method->clazz->explicitFields.insert(method->clazz->fieldSlots.slotFor(left->get(IDENT)->symbol));
 					}
 
 					//OUT << "Inferring type for: " << instanceVar << END;
@@ -1164,7 +1272,7 @@ std::string Typechecker::typeInferStmt(Qmethod *method, AST::Node *stmt, bool &c
 					//OUT << "	curr_type: " << curr_type << END;
 					std::string assigned_type = typeInferStmt(method, r_expr, changed, ret_flag);
 					//OUT << "	assigned_type: " << assigned_type << END << END;
-					if (isInstanceVarExplicit(method, instanceVar)) {
+					if (isInstanceVarExplicit(method, left->get(IDENT)->symbol)) {
 						if (!isSubclassOrEqual(curr_type, assigned_type)) {
 							RED << stageString(TYPEINFERENCE) << "instance variable \""
 								<< instanceVar << "\" in class \""
@@ -1180,7 +1288,7 @@ std::string Typechecker::typeInferStmt(Qmethod *method, AST::Node *stmt, bool &c
 					//OUT << "	new_type: " << new_type<< END;
 					if (new_type != curr_type) {
 						method->clazz->instanceVarType[instanceVar] = new_type;
-						changed = true;
+						enqueueInference(method->clazz->fieldReaders[instanceVar]);
 					}
 					return new_type;
 				}
@@ -1192,45 +1300,43 @@ std::string Typechecker::typeInferStmt(Qmethod *method, AST::Node *stmt, bool &c
 		// assign of form "x = ..." and "x : Clss = ..."
 		left = stmt->get(IDENT, LOC);
 		if (left != NULL) {
-			if (stmt->skip) return method->type[left->name];
+			if (stmt->skip) return method->type[left->name()];
 			// if it has an explicit type
 			AST::Node *explicit_type = stmt->get(IDENT, TYPE_IDENT);
 			if (explicit_type != NULL) {
-				if (!doesClassExist(explicit_type->name)) {
+				if (!doesClassExist(explicit_type->name())) {
 					RED << stageString(TYPEINFERENCE) << "attempt to assign explicit type with unknown class \""  
-						<< explicit_type->name << "\" in method " << method->name << "() in class \"" 
+						<< explicit_type->name() << "\" in method " << method->name << "() in class \"" 
 						<< method->clazz->name << "\"" << END;
 					report::trackError(TYPEINFERENCE);
 					ret_flag = false;
 					stmt->skip = true;
-					return method->type[left->name];
+					return method->type[left->name()];
 				}
 				// OUT << "Var Name: " << left->name << " Curr Type: " << method->type[left->name] << " Explicit Type: " << explicit_type->name << END;
-				if (isSubclassOrEqual(method->type[left->name], explicit_type->name)) {
-					method->type[left->name] = explicit_type->name;
+				if (isSubclassOrEqual(method->type[left->name()], explicit_type->name())) {
+					method->type[left->name()] = explicit_type->name();
 				} else {
 					RED << stageString(TYPEINFERENCE) << "variable \""
-						<< left->name << "\" in " << method->name <<  "() in class \""
-						<< method->clazz->name << "\" is assigned invalid explicit type \"" << explicit_type->name << "\"" << END;
+						<< left->name() << "\" in " << method->name <<  "() in class \""
+						<< method->clazz->name << "\" is assigned invalid explicit type \"" << explicit_type->name() << "\"" << END;
 					report::trackError(TYPEINFERENCE);
 					ret_flag = false;
 					stmt->skip = true;
-					return method->type[left->name];
-				}
-				if (!isVarExplicit(method, left->name)) {
-					method->explicitVars.push_back(left->name);
+					return method->type[left->name()];
 				}
+				method->explicitVars.insert(method->locals.slotFor(left->symbol));
 			}
 
 			// infer type if we don't have an explicit one
-			std::string curr_type = method->type[left->name];
+			std::string curr_type = method->type[left->name()];
 			//OUT << "curr_type: " << curr_type << END;
 			std::string assigned_type = typeInferStmt(method, r_expr, changed, ret_flag);
 			//OUT << "assigned_type: " << assigned_type << END;
-			if (isVarExplicit(method, left->name)) {
+			if (isVarExplicit(method, left->symbol)) {
 				if (!isSubclassOrEqual(assigned_type, curr_type)) {
 					RED << stageString(TYPEINFERENCE) << "variable \""
-						<< left->name << "\" in " << method->name <<  "() in class \""
+						<< left->name() << "\" in " << method->name <<  "() in class \""
 						<< method->clazz->name << "\" is assigned invalid type \"" << assigned_type << "\"" << END;
 					report::trackError(TYPEINFERENCE);
 					ret_flag = false;
@@ -1242,7 +1348,7 @@ std::string Typechecker::typeInferStmt(Qmethod *method, AST::Node *stmt, bool &c
 			std::string new_type = leastCommonAncestor(curr_type, assigned_type);
 			//OUT << "new_type: " << new_type << END;
 			if (new_type != curr_type) {
-				method->type[left->name] = new_type;
+				method->type[left->name()] = new_type;
 				changed = true;
 			}
 			return new_type;
@@ -1257,15 +1363,16 @@ std::string Typechecker::typeInferStmt(Qmethod *method, AST::Node *stmt, bool &c
 
 		AST::Node *rhs = stmt->rawChildren[1];
 		if (rhs->type == IDENT) { // should always be an ident... but we can check anyways
-			std::string rhsName = rhs->name; 
+			std::string rhsName = rhs->name(); 
 			//OUT << rhsName << END;
-			if (!isInstanceVar(lhsClass->constructor, rhsName)) {
+			if (!isInstanceVar(lhsClass->constructor, rhs->symbol)) {
 				RED << stageString(TYPEINFERENCE) << "attempt to access unknown instance variable \"" 
 					<< rhsName << "\" from class type \"" << lhsType << "\" in " << method->name <<  "() in class \""
 					<< method->clazz->name << "\"" << END;
 					report::trackError(TYPEINFERENCE);
 				ret_flag = false;
 			} else {
+				lhsClass->fieldReaders[rhsName].insert(method);
 				//OUT << "returning type " << lhsClass->instanceVarType[rhsName] << " from DOT" << END << END;
 				return lhsClass->instanceVarType[rhsName]; // get the type of that instance var from the other class
 			}
@@ -1273,7 +1380,7 @@ std::string Typechecker::typeInferStmt(Qmethod *method, AST::Node *stmt, bool &c
 
 	} else if (nodeType == LOAD) {
 		if (stmt->get(IDENT) != NULL) { 
-			std::string ident = stmt->get(IDENT)->name;
+			std::string ident = stmt->get(IDENT)->name();
 			if (ident == "this") {
 				return method->clazz->name;
 			} else if (ident == "true" || ident == "false") { 
@@ -1296,8 +1403,8 @@ std::string Typechecker::typeInferStmt(Qmethod *method, AST::Node *stmt, bool &c
 		return "String";
 
 	} else if (nodeType == IDENT) {
-		if (stmt->name == "Nothing") return "Nothing";
-		if (stmt->name == "true" || stmt->name == "false") return "Boolean";
+		if (stmt->name() == "Nothing") return "Nothing";
+		if (stmt->name() == "true" || stmt->name() == "false") return "Boolean";
 	}
 
 	return "$UNKNOWN";
@@ -1314,38 +1421,78 @@ bool Typechecker::typeInferQmethod(Qmethod *method, bool &changed) {
 	return ret_flag;
 }
 
+void Typechecker::enqueueInference(Qmethod *method) {
+	if (!method->queued) {
+		method->queued = true;
+		this->worklist.push_back(method);
+	}
+}
+
+void Typechecker::enqueueInference(const MethodSet &methods) {
+	for (Qmethod *m : methods) {
+		enqueueInference(m);
+	}
+}
+
+// infer methods off the worklist until it's empty. a method goes back on when its own
+// variables' types changed; the methods that read a field or a return type that changed
+// are put on by whoever changed it
+bool Typechecker::runInferenceWorklist() {
+	bool ret_flag = true;
+	while (!this->worklist.empty()) {
+		Qmethod *method = this->worklist.front();
+		this->worklist.pop_front();
+		method->queued = false;
+
+		bool changed = false;
+		if (!typeInferQmethod(method, changed)) ret_flag = false;
+		this->inferencePasses++;
+		if (changed) {
+			enqueueInference(method);
+		}
+	}
+	return ret_flag;
+}
+
+// Instead of re-inferring every method until nothing changes anywhere, each method is
+// inferred once and then again only when something it used has changed, so a change
+// to one field costs the methods that read it rather than another pass over the program.
 bool Typechecker::typeInferenceCheck() {
 	bool ret_flag = true;
+	int order = 0;
 
 	// check all constructors first so all possible instance vars have types
-	bool changed;
-	do {
-		changed = false;
-		for (auto clss : this->classes) {
-			if (isBuiltin(clss.second->name)) { 
-				continue;
-			}
-			if (!typeInferQmethod(clss.second->constructor, changed)) ret_flag = false;
+	for (auto clss : this->classes) {
+		if (isBuiltin(clss.second->name)) { 
+			continue;
 		}
-	} while (changed);
+		clss.second->constructor->inferOrder = order++;
+		enqueueInference(clss.second->constructor);
+	}
+	if (!runInferenceWorklist()) ret_flag = false;
 
 	// check all other methods and main
-	do {
-		changed = false;
-		for (auto clss : this->classes) {
-			if (isBuiltin(clss.second->name)) { 
-				continue;
-			}
-			for (Qmethod *m : clss.second->methods) {
-				if(!typeInferQmethod(m, changed)) ret_flag = false;
-			}
+	for (auto clss : this->classes) {
+		if (isBuiltin(clss.second->name)) { 
+			continue;
 		}
-
-		// init check the main statements
-		if (this->main != NULL) {
-			if (!typeInferQmethod(this->main->constructor, changed)) ret_flag = false;
+		for (Qmethod *m : clss.second->methods) {
+			m->inferOrder = order++;
+			enqueueInference(m);
 		}
-	} while (changed);
+	}
+
+	// init check the main statements
+	if (this->main != NULL) {
+		this->main->constructor->inferOrder = order++;
+		enqueueInference(this->main->constructor);
+	}
+	if (!runInferenceWorklist()) ret_flag = false;
+
+	if (report::getVerbose()) {
+		report::note("type inference took " + std::to_string(this->inferencePasses) + " method passes over "
+			+ std::to_string(order) + " methods", TYPECHECKER);
+	}
 
 	return ret_flag;
 }
@@ -1360,7 +1507,7 @@ bool Typechecker::fieldsCompatibleCheck() {
 
 		for (std::string instanceVar : parent->instanceVars) {
 			if (instanceVar == "this") continue; // don't want to compare the actual classes
-			if (std::find(child->instanceVars.begin(), child->instanceVars.end(), instanceVar) == child->instanceVars.end()) {
+			if (!child->fields.test(child->fieldSlots.find(symbols.find(instanceVar)))) {
 				RED << stageString(INITBEFOREUSE) << "child class \"" << child->name << "\" does not define field \"" 
 					<< instanceVar << "\"" << END;
 					report::trackError(INITBEFOREUSE);
@@ -1404,6 +1551,10 @@ bool Typechecker::checkProgram() {
         report::gnote("circular dependency check passed.", TYPECHECKER);
     }
 
+    // with the hierarchy known to be a tree, it can be indexed and every class's methods resolved once
+    this->buildHierarchyIndex();
+    this->buildMethodTables();
+
     bool methodsWelltyped = this->methodSignaturesTypecheck();
     if (!methodsWelltyped) {
     	report::error("method signature type check failed!", TYPECHECKER);
@@ -1455,35 +1606,54 @@ bool Typechecker::checkProgram() {
     return true;
 }
 
-bool Typechecker::isVarInit(Qmethod *method, std::string ident) {
-	return std::find(method->init.begin(), 
-		method->init.end(), ident) != method->init.end();
+bool Typechecker::isVarInit(Qmethod *method, Symbol ident) {
+	return method->init.test(method->locals.find(ident));
 }
 
-bool Typechecker::isVarArg(Qmethod *method, std::string ident) {
-	return std::find(method->args.begin(), 
-		method->args.end(), ident) != method->args.end();
+// the args are the first locals a method has, so they have the lowest slots
+bool Typechecker::isVarArg(Qmethod *method, Symbol ident) {
+	int slot = method->locals.find(ident);
+	return slot >= 0 && slot < (int) method->args.size();
 }
 
-bool Typechecker::isVarExplicit(Qmethod *method, std::string ident) {
-	return std::find(method->explicitVars.begin(), 
-		method->explicitVars.end(), ident) != method->explicitVars.end();
+bool Typechecker::isVarExplicit(Qmethod *method, Symbol ident) {
+	return method->explicitVars.test(method->locals.find(ident));
 }
 
-bool Typechecker::isInstanceVar(Qmethod *method, std::string ident) {
-	return std::find(method->clazz->instanceVars.begin(), 
-		method->clazz->instanceVars.end(), ident) != method->clazz->instanceVars.end();
+bool Typechecker::isInstanceVar(Qmethod *method, Symbol ident) {
+	return method->clazz->fields.test(method->clazz->fieldSlots.find(ident));
 }
 
-bool Typechecker::isInstanceVarExplicit(Qmethod *method, std::string ident) {
-	return std::find(method->clazz->explicitFields.begin(), 
-		method->clazz->explicitFields.end(), ident) != method->clazz->explicitFields.end();
+bool Typechecker::isInstanceVarExplicit(Qmethod *method, Symbol ident) {
+	return method->clazz->explicitFields.test(method->clazz->fieldSlots.find(ident));
+}
+
+void Typechecker::addInstanceVar(Qclass *clazz, Symbol ident) {
+	clazz->instanceVars.push_back(symbols.name(ident));
+	clazz->fields.insert(clazz->fieldSlots.slotFor(ident));
 }
 
 std::string Typechecker::getSuperClass(std::string class1) {
 	return classes[class1]->super;
 }
 
+// the method a class responds to with the given name, or NULL if there isn't one
+Qmethod* Typechecker::resolveMethod(Qclass *clazz, Symbol name) {
+	auto slot = clazz->slots.find(name);
+	if (slot == clazz->slots.end()) return NULL;
+	return clazz->vtable[slot->second];
+}
+
+// the class a symbol names, or NULL if there isn't one
+Qclass* Typechecker::findClass(Symbol id) {
+	if (id == NO_SYMBOL || (size_t) id >= classTable.size()) return NULL;
+	return classTable[id];
+}
+
+Qclass* Typechecker::findClass(const std::string &name) {
+	return findClass(symbols.find(name));
+}
+
 bool Typechecker::isBuiltin(std::string classname) {
 	if (classname == "Obj" || classname == "String" || classname == "Nothing"
 		|| classname == "Int" || classname == "Boolean") { 
@@ -1508,21 +1678,15 @@ bool Typechecker::isSubclassOrEqual(std::string class1, std::string class2) {
 	//if (class2 == "") return true;
 	if (class1 == class2) return true;
 	if (class2 == "Obj") return true;
-	if (classes[class1]->super == "Obj" && class2 == "Obj") return true;
 
-	std::string tempSuper = class1;
-	while (tempSuper != class2 || tempSuper != "Obj") {
-		if (tempSuper == "Obj") break;
-		if (tempSuper == class2) return true;
+	Qclass *sub = findClass(class1);
+	Qclass *super = findClass(class2);
+	if (sub == NULL || super == NULL) return false;
+	return isSubclassOrEqual(sub, super);
+}
 
-		for (auto clss : classes) {
-			Qclass *second = clss.second;
-			if (second->name == tempSuper) {
-				tempSuper = second->super;
-			}
-		}
-	}
-	return false;
+bool Typechecker::isSubclassOrEqual(Qclass *class1, Qclass *class2) {
+	return class2->tourIn <= class1->tourIn && class1->tourOut <= class2->tourOut;
 }
 
 // the old type in type inference must be passed in as the first argument
@@ -1533,55 +1697,28 @@ std::string Typechecker::leastCommonAncestor(std::string class1, std::string cla
 	if (class1 == "$UNKNOWN" || class1 == "") return class2;
 	if (!doesClassExist(class1) || !doesClassExist(class2)) return "$UNKNOWN";
 
-	std::vector<std::string> class1Supers;
+	return leastCommonAncestor(findClass(class1), findClass(class2))->name;
+}
 
-	if (class1 == "Obj") {
-		class1Supers.push_back(class1);
-	} else {
-		class1Supers.push_back(class1);
-		std::string tempSuper1 = class1;
+Qclass* Typechecker::leastCommonAncestor(Qclass *class1, Qclass *class2) {
+	if (isSubclassOrEqual(class1, class2)) return class2;
+	if (isSubclassOrEqual(class2, class1)) return class1;
 
-		while (tempSuper1 != "Obj") {
-			if (tempSuper1 == "Obj") {
-				break;
-			}
-			class1Supers.push_back(classes[tempSuper1]->super);
-			tempSuper1 = classes[tempSuper1]->super;
+	// bring the deeper class up to the other's depth, then jump both up as far as
+	// they can go without meeting. their supers are then the common ancestor
+	if (class1->depth < class2->depth) std::swap(class1, class2);
+	for (int k = (int) class1->ancestors.size() - 1; k >= 0; k--) {
+		if (class1->depth - (1 << k) >= class2->depth) {
+			class1 = class1->ancestors[k];
 		}
-		class1Supers.push_back("Obj");
 	}
-
-	std::vector<std::string> class2Supers;
-
-	if (class2 == "Obj") {
-		class2Supers.push_back(class2);
-	} else {
-		class2Supers.push_back(class2);
-		std::string tempSuper2 = class2;
-
-		while (tempSuper2 != "Obj") {
-			if (tempSuper2 == "Obj") {
-				break;
-			}
-			class2Supers.push_back(classes[tempSuper2]->super);
-			tempSuper2 = classes[tempSuper2]->super;
+	for (int k = (int) class1->ancestors.size() - 1; k >= 0; k--) {
+		if (k < (int) class1->ancestors.size() && class1->ancestors[k] != class2->ancestors[k]) {
+			class1 = class1->ancestors[k];
+			class2 = class2->ancestors[k];
 		}
-		class2Supers.push_back("Obj");
 	}
-
-	std::string retVal;
-
-	for (auto super : class2Supers) {
-		auto it = std::find(class1Supers.begin(), class1Supers.end(), super);
-		if (it != class1Supers.end()) {
-			retVal = *(it);
-			break;
-		} else {
-			retVal = "Obj";
-		}
-	}
-
-	return retVal;
+	return class1->ancestors[0];
 }
 
 void Typechecker::printQclass(Qclass *clazz) {
@@ -1594,7 +1731,7 @@ void Typechecker::printQclass(Qclass *clazz) {
 	OUT << "	Instance vars: " << END;
 	for (std::string s : clazz->instanceVars) {
 		OUT << "	Name: " << s << ", Type: " << clazz->instanceVarType[s];
-		if (isInstanceVarExplicit(clazz->constructor, s)) {
+		if (isInstanceVarExplicit(clazz->constructor, symbols.find(s))) {
 			OUT << " (explicit)";
 		}
 		OUT << END;
@@ -1612,8 +1749,9 @@ void Typechecker::printQmethod(Qmethod *method) {
 	OUT << "	Inside class: " << method->clazz->name << END;
 	OUT << "	Return type: " << method->type["return"] << END;
 	OUT << "	Initialized vars: " << END;
-	for (std::string s : method->init) {
-		OUT << "		" << s;
+	for (int slot : method->init.slots()) {
+		Symbol s = method->locals.name(slot);
+		OUT << "		" << symbols.name(s);
 		if (isVarArg(method, s)) {
 			OUT << " (arg) (explicit)";
 		}
@@ -1631,5 +1769,31 @@ void Typechecker::printQmethod(Qmethod *method) {
 	for (AST::Node *stmt : method->stmts) { // print each stmt type inside Qmethod's stmts vector
 			OUT << "		" << typeString(stmt->type) << END;
 	}
+
+	// the blocks the method breaks into, what's live at the top of each, and which
+	// assignments (numbered in order) might still be what a variable holds there
+	ControlFlowGraph cfg(method->stmts);
+	DataflowResult live = solveDataflow(cfg, liveVariables(cfg, method->locals));
+	std::vector<AST::Node*> definitions;
+	DataflowResult reaching = solveDataflow(cfg, reachingDefinitions(cfg, definitions));
+	OUT << "	Blocks: " << END;
+	for (auto &block : cfg.blocks) {
+		OUT << "		block " << block->id << " (" << block->stmts.size() << " stmts) ->";
+		for (BasicBlock *succ : block->succs) {
+			OUT << " " << succ->id;
+		}
+		if (!cfg.isReachable(block.get())) OUT << " (unreachable)";
+		OUT << END;
+		OUT << "			live:";
+		for (int slot : live.in[block->id].slots()) {
+			OUT << " " << symbols.name(method->locals.name(slot));
+		}
+		OUT << END;
+		OUT << "			reaching:";
+		for (int slot : reaching.in[block->id].slots()) {
+			OUT << " " << symbols.name(assignedVariable(definitions[slot])) << "#" << slot;
+		}
+		OUT << END;
+	}
 	OUT << END;
 }
\ No newline at end of file
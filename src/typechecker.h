@@ -1,9 +1,16 @@
 #ifndef TYPECHECKER_H
 #define TYPECHECKER_H
 
-#include <stack>
+#include <deque>
+#include <functional>
+#include <set>
+#include <unordered_map>
 #include "ASTNode.h"
 #include "Messages.h"
+#include "cfg.h"
+#include "dataflow.h"
+#include "slotset.h"
+#include "threadpool.h"
 
 // Qmethod is a struct storing everything you need 
 // to know about a method for type checking. The info
@@ -13,6 +20,14 @@
 // we can assume arguments are initialized, and return type is static.
 
 struct Qclass; // needs to forward declared as each struct holds the other in some form
+struct Qmethod;
+
+// orders methods by when type inference first got to them, so that sets of methods
+// are walked in the same order on every run (and errors come out in the same order)
+struct InferenceOrder {
+    bool operator()(const Qmethod *a, const Qmethod *b) const;
+};
+typedef std::set<Qmethod*, InferenceOrder> MethodSet;
 
 struct Qmethod {
     AST::Node *node; // pointer to the node in the tree
@@ -23,29 +38,95 @@ struct Qmethod {
     Qclass *clazz;
     
     std::string name;
+    Symbol id; // the name, interned
+
+    // where this method sits in the method tables (see Typechecker::buildMethodTables),
+    // and the method from a super class that it overrides, if any
+    int slot = -1;
+    Qmethod *overrides = NULL;
 
     // mainly for type inference/method compatibility
     std::vector<std::string> args;
     std::map<std::string, std::string> argtype;
 
-    // tracking of initialized variables and their types
-    std::vector<std::string> init;
-    std::vector<std::string> explicitVars;
+    // tracking of initialized variables and their types. every local gets a slot
+    // (the args get the first ones), and init and explicitVars are sets of slots
+    SlotTable locals;
+    SlotSet init;
+    SlotSet explicitVars;
     std::map<std::string, std::string> type;
     
     std::vector<AST::Node*> stmts;
+
+    // for the type inference worklist (see Typechecker::typeInferenceCheck): the methods
+    // that call this one and so use its return type, where it is in the inference order,
+    // and whether it's waiting on the worklist
+    MethodSet callers;
+    int inferOrder = -1;
+    bool queued = false;
 };
 
+inline bool InferenceOrder::operator()(const Qmethod *a, const Qmethod *b) const {
+    return a->inferOrder < b->inferOrder;
+}
+
 struct Qclass {
     AST::Node *node; // pointer to the node in the tree
     std::string name;
     std::string super;
+    Symbol id; // the name and super's name, interned
+    Symbol superId;
     Qmethod *constructor;
     std::vector<Qmethod*> methods;    
-    // for use in init before use checking in non constructor methods
+    // every method an instance responds to, in slot order (the super's slots come first,
+    // so a slot means the same thing all the way down the hierarchy), and the slot for
+    // each method name. an inherited method's clazz is the class that defined it
+    std::vector<Qmethod*> vtable;
+    std::unordered_map<int, int> slots;
+    bool vtableBuilt = false;
+    // where the class sits in the hierarchy (see Typechecker::buildHierarchyIndex): its
+    // subclasses, how far down from Obj it is, the interval of the walk over the tree that
+    // its subclasses all fall in, and ancestors[k], its super 2^k levels up
+    std::vector<Qclass*> subclasses;
+    int depth = 0;
+    int tourIn = 0;
+    int tourOut = 0;
+    std::vector<Qclass*> ancestors;
+    // for use in init before use checking in non constructor methods. instanceVars keeps
+    // the fields in the order they're laid out in, the sets are of slots in fieldSlots
     std::vector<std::string> instanceVars;
-    std::vector<std::string> explicitFields;
+    SlotTable fieldSlots;
+    SlotSet fields;
+    SlotSet explicitFields;
     std::map<std::string, std::string> instanceVarType;
+    // the methods that have read each instance variable's type, to be inferred again if it changes
+    std::map<std::string, MethodSet> fieldReaders;
+};
+
+// What the init before use check knows as it walks a method: the method's control
+// flow graph, the locals (and, in a constructor, the fields) that are definitely
+// initialized at the top of each block, and, as the walk goes through a block, which
+// are just before the statement it has got to. Code nothing reaches is checked as
+// though it ran on from the code before it.
+struct InitState {
+    ControlFlowGraph cfg;
+    DataflowResult vars;
+    DataflowResult fields;
+    SlotTable *locals;
+    SlotTable *fieldSlots; // NULL outside of constructors
+    BasicBlock *block = NULL;
+    SlotSet varsNow;
+    SlotSet fieldsNow;
+
+    InitState(Qmethod *method, bool isConstructor);
+
+    // before a statement: catch up if it starts a new block
+    void enter(AST::Node *stmt);
+    // after a statement: take in what it assigned, or where an if, while or typecase comes out
+    void leave(AST::Node *stmt);
+    // a field that some path into where an if, while or typecase comes out doesn't
+    // assign and another does (the first path's first), or -1 if they all agree
+    int unevenField(AST::Node *stmt) const;
 };
 
 class Typechecker {
@@ -57,18 +138,25 @@ class Typechecker {
         AST::Node *root;
         AST::Node *stubs;
 
-        // map from class name -> struct
+        // map from class name -> struct, and the same classes indexed by symbol
         std::map<std::string, Qclass*> classes;
-        std::map<std::string, std::vector<std::string>> class_hierarchy;
+        std::vector<Qclass*> classTable;
 
         // we create a main class to wrap our program's statements
         Qclass* main;
 
+        // methods waiting to be inferred (again), and how many times a method has been inferred
+        std::deque<Qmethod*> worklist;
+        int inferencePasses = 0;
+
+        // the threads that checks on separate classes are spread across
+        ThreadPool pool;
+
         /* ========================== */
         /* Constructors & Destructors */
         /* ========================== */
 
-        Typechecker(AST::Node *root, AST::Node *stubs) : root(root), stubs(stubs) { initialize(); };
+        Typechecker(AST::Node *root, AST::Node *stubs, int threads = 1) : root(root), stubs(stubs), pool(threads) { initialize(); };
         virtual ~Typechecker() {};
 
         /* ======= */
@@ -83,44 +171,63 @@ class Typechecker {
         // - check for circular dependency
         // - check if class method definitions are compatible with parent's
         bool classHierarchyCheck();
+        void buildHierarchyIndex();
+        void buildMethodTables();
+        void buildMethodTable(Qclass *clazz);
         bool methodSignaturesTypecheck();
+        bool methodSignaturesTypecheck(Qclass *clazz);
         bool methodsCompatibleCheck();
 
         // Type checking: phase two
         // - init before use on constructors
         // - check instance vars of children match parents
         // - init before use on methods
-        bool initCheckStmt(Qmethod *method, AST::Node *stmt, 
-                            std::vector<std::string> &var_init,
-                            std::vector<std::string> &field_init,
+        bool initCheckStmt(Qmethod *method, AST::Node *stmt, InitState &state,
+                            bool isConstructor, bool isMainStatements);
+        bool initCheckStmts(Qmethod *method, const AST::NodeList &stmts, InitState &state,
                             bool isConstructor, bool isMainStatements);
         bool initCheckQmethod(Qmethod *method, bool isConstructor, bool isMainStatements);
+        bool initCheckQclass(Qclass *clazz);
         bool initializeBeforeUseCheck();
 
         // Type checking: phase three
         // - type inference on constructors
         // - type inference on methods
         std::string typeInferStmt(Qmethod *method, AST::Node *stmt, bool &changed, bool &ret_flag);
+        std::string typeInferNode(Qmethod *method, AST::Node *stmt, bool &changed, bool &ret_flag);
         bool typeInferQmethod(Qmethod *method, bool &changed);
+        void enqueueInference(Qmethod *method);
+        void enqueueInference(const MethodSet &methods);
+        bool runInferenceWorklist();
         bool typeInferenceCheck();
         bool fieldsCompatibleCheck();
 
+        // runs check(0) .. check(count - 1) on the pool, then prints what each one
+        // reported in that order, as though they had been run one after another
+        bool checkEach(size_t count, const std::function<bool(size_t)> &check);
+
         // Type check our entire program and report errors/bail appropriately
         // this returns true back to driver.cpp if we passed all checks
         bool checkProgram();
 
         // "helper" methods used throughout type checking
-        bool isInstanceVar(Qmethod *method, std::string ident);
-        bool isInstanceVarExplicit(Qmethod *method, std::string ident);
+        bool isInstanceVar(Qmethod *method, Symbol ident);
+        bool isInstanceVarExplicit(Qmethod *method, Symbol ident);
+        void addInstanceVar(Qclass *clazz, Symbol ident);
 
-        bool isVarInit(Qmethod *method, std::string ident);
-        bool isVarArg(Qmethod *method, std::string ident);
-        bool isVarExplicit(Qmethod *method, std::string ident);
+        bool isVarInit(Qmethod *method, Symbol ident);
+        bool isVarArg(Qmethod *method, Symbol ident);
+        bool isVarExplicit(Qmethod *method, Symbol ident);
         bool isBuiltin(std::string classname);
         bool doesClassExist(std::string classname);
         bool isSubclassOrEqual(std::string class1, std::string class2);
+        bool isSubclassOrEqual(Qclass *class1, Qclass *class2);
         std::string leastCommonAncestor(std::string class1, std::string class2);
+        Qclass* leastCommonAncestor(Qclass *class1, Qclass *class2);
         std::string getSuperClass(std::string class1);
+        Qclass* findClass(Symbol id);
+        Qclass* findClass(const std::string &name);
+        Qmethod* resolveMethod(Qclass *clazz, Symbol name);
 
         Qclass* createQclass(AST::Node *clazz);
         Qmethod* createQmethod(AST::Node *method, Qclass *containerClass, bool isConstructor);